@@ -0,0 +1,29 @@
+#pragma once
+
+/* Accuracy tiers for the SIMD_vecf math functions.
+
+Without a tier, exp(), log(), sin(), pow(), sqrt(), rcp() and rsqrt() are precise: within a few ulps (see SIMD_math.inl). Passing a tier
+trades accuracy for throughput, picked at compile time by overload:
+
+SIMD_fast       ~1e-4 relative error (about 13 bits). The rcp/rsqrt estimate instructions and degree 2-4 polynomials
+SIMD_standard   ~2e-7 relative error (2-3 ulps). One Newton step on the estimates and degree 4-8 polynomials. pow() rounds
+                y * log2(x) to float, so its error grows with that product: ~3e-6 at 50
+SIMD_precise    The untagged functions
+
+sin() errors are absolute. main.cpp's benchmark_accuracy_tiers() measures every tier; its results are at the top of main.cpp.
+
+The fast and standard tiers skip the special case handling of the precise ones. exp() and pow() saturate to 0 and infinity outside
+[2^-127, 2^128), log(), pow() and sqrt() take positive, normal x, and sin() loses accuracy past |x| = 8192 in standard and 64 in fast.
+
+Usage:
+x.inline_exp(SIMD_fast);
+SIMD_vecf length = (x * x + y * y).sqrt(SIMD_standard);
+*/
+
+struct SIMD_fast_t {};
+struct SIMD_standard_t {};
+struct SIMD_precise_t {};
+
+const SIMD_fast_t SIMD_fast = {};
+const SIMD_standard_t SIMD_standard = {};
+const SIMD_precise_t SIMD_precise = {};
@@ -0,0 +1,150 @@
+#pragma once
+#include <immintrin.h>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+
+/* Allocators for weaved_array: where its one allocation comes from.
+
+An allocator is a type with
+    static void* allocate(size_t bytes)            At least 64-byte aligned, throws std::bad_alloc on failure
+    static void deallocate(void* data, size_t bytes)   Called with the same size allocate() was
+
+aligned_allocator is _mm_malloc at 64 bytes, a cache line and the widest vector. Every page of it is 4KB, so an 80M-element array
+spans 80 thousand pages and a kernel streaming through it misses the TLB about once every thousand vectors.
+
+huge_page_allocator backs the array with 2MB pages, 512 times fewer. On Linux it maps pages from the reserved pool (MAP_HUGETLB,
+see /proc/sys/vm/nr_hugepages) and, if none are reserved, maps 2MB-aligned memory and asks for transparent huge pages with
+madvise(MADV_HUGEPAGE). On Windows it asks for large pages, which needs the "Lock pages in memory" privilege, and otherwise takes
+ordinary pages. Either way the allocation succeeds if plain memory is available; only the page size is best effort.
+
+Both take prefault. The OS hands out pages on first write, so without it the first kernel launch over a new array also pays for every
+page fault, zeroing included. With it the allocator writes to every page up front and launches run at full bandwidth from the start.
+
+Usage:
+weaved_array<float, 2, 80000000, planar_layout, huge_page_allocator<>> arrays; // 2MB pages, already faulted in
+*/
+
+// Bytes between the starts of consecutive pages the allocators touch when prefaulting. Writing to every 4KB page also covers 2MB ones
+#define SIMD_PREFAULT_STRIDE 4096
+
+// Writes to every page of data so the OS maps them now rather than during the first launch
+inline void SIMD_prefault(void* data, size_t bytes) {
+    char* bytes_data = static_cast<char*>(data);
+    for (size_t offset = 0; offset < bytes; offset += SIMD_PREFAULT_STRIDE) {
+        bytes_data[offset] = 0;
+    }
+}
+
+template <bool prefault = false>
+struct aligned_allocator {
+    static const size_t alignment = 64;
+
+    static void* allocate(size_t bytes) {
+        void* data = _mm_malloc(bytes == 0 ? alignment : bytes, alignment);
+        if (data == nullptr) {
+            throw std::bad_alloc();
+        }
+        if (prefault) {
+            SIMD_prefault(data, bytes);
+        }
+        return data;
+    }
+
+    static void deallocate(void* data, size_t) {
+        _mm_free(data);
+    }
+};
+
+template <bool prefault = true>
+struct huge_page_allocator {
+    static const size_t alignment = 64;
+    static const size_t page_size = 2 * 1024 * 1024;
+
+    static void* allocate(size_t bytes) {
+        void* data = map(rounded(bytes));
+        if (prefault) {
+            SIMD_prefault(data, bytes);
+        }
+        return data;
+    }
+
+    static void deallocate(void* data, size_t bytes) {
+#if defined(_WIN32)
+        (void)bytes;
+        VirtualFree(data, 0, MEM_RELEASE);
+#elif defined(__linux__)
+        munmap(data, rounded(bytes));
+#else
+        (void)bytes;
+        _mm_free(data);
+#endif
+    }
+
+private:
+    // Huge pages come whole, so the mapping is rounded up to one
+    static size_t rounded(size_t bytes) {
+        return (bytes + page_size - 1) / page_size * page_size + (bytes == 0 ? page_size : 0);
+    }
+
+    static void* map(size_t bytes) {
+#if defined(_WIN32)
+        SIZE_T large_page = GetLargePageMinimum();
+        if (large_page != 0 && bytes % large_page == 0) {
+            void* data = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (data != nullptr) {
+                return data;
+            }
+        }
+        void* data = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (data == nullptr) {
+            throw std::bad_alloc();
+        }
+        return data;
+#elif defined(__linux__)
+#if defined(MAP_HUGETLB)
+        void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (data != MAP_FAILED) {
+            return data;
+        }
+#endif
+        // No reserved huge pages: map a page extra, keep the 2MB-aligned part, and let the kernel back it with transparent huge pages
+        size_t padded = bytes + page_size;
+        void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        char* start = static_cast<char*>(raw);
+        char* aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(start) + page_size - 1) / page_size * page_size);
+        if (aligned != start) {
+            munmap(start, aligned - start);
+        }
+        if (aligned + bytes != start + padded) {
+            munmap(aligned + bytes, start + padded - (aligned + bytes));
+        }
+#if defined(MADV_HUGEPAGE)
+        madvise(aligned, bytes, MADV_HUGEPAGE);
+#endif
+        return aligned;
+#else
+        void* data = _mm_malloc(bytes, page_size);
+        if (data == nullptr) {
+            throw std::bad_alloc();
+        }
+        return data;
+#endif
+    }
+};
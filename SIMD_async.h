@@ -0,0 +1,145 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define SIMD_HAS_COROUTINES
+#endif
+#endif
+
+
+/* Futures for compute_engine's asynchronous launches.
+
+call_SIMD_operation and the other launches return once the work is done, with the calling thread taking part as worker 0. The _async
+launches (call_SIMD_operation_async, run_async) queue the launch instead and return a SIMD_future straight away. Every engine runs its
+queue in order on a launch thread of its own, started on the first asynchronous launch, which takes the calling thread's place as
+worker 0. In the meantime the caller is free to prepare the next batch.
+
+Until the future is ready the launch may still be reading and writing the arrays, so they must stay alive and untouched by the caller.
+Launches from any thread are serialized, so a blocking launch made while asynchronous ones are queued waits for the one running.
+
+A future's then() queues another launch for once this one is done, and returns that launch's future. If a launch throws, wait() on
+its future rethrows the exception, and launches chained after it are skipped and rethrow it too. Built as C++20 with coroutine
+support, a future can also be co_awaited; the coroutine is resumed on the engine's launch thread. Continuations and coroutines
+running there must not wait() on a launch of the same engine, since that launch can only run after they return.
+
+Usage:
+SIMD_future batch = engine.call_SIMD_operation_async(arrays, pythagorean_kernel());
+prepare_next_batch();                            // Runs while the kernel does
+batch.then([&](compute_engine& engine) { engine.call_SIMD_operation(arrays, scale_kernel()); }).wait();
+co_await engine.call_SIMD_operation_async(arrays, pythagorean_kernel()); // In a coroutine
+*/
+class compute_engine;
+
+// What a SIMD_future and the launch it waits for share: whether the launch is done, how it failed, and what to do when it's done
+class SIMD_launch_state {
+public:
+    SIMD_launch_state() : ready(false) {}
+
+    // Called once the launch is done, with the exception it threw if any. Wakes wait() and runs everything passed to on_ready()
+    void finish(std::exception_ptr failure) {
+        std::vector<std::function<void()>> waiting;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            error = failure;
+            ready = true;
+            waiting.swap(waiters);
+        }
+        done.notify_all();
+
+        for (auto& waiter : waiting) {
+            waiter();
+        }
+    }
+
+    bool is_ready() {
+        std::lock_guard<std::mutex> guard(lock);
+        return ready;
+    }
+
+    // Blocks until the launch is done, then rethrows what it threw
+    void wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [this] { return ready; });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Only valid once the launch is done
+    std::exception_ptr failure() const { return error; }
+
+    // Has finish() run waiter, on the thread that finishes the launch. Returns false without keeping it if the launch is already done
+    bool on_ready(std::function<void()> waiter) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (ready) {
+            return false;
+        }
+        waiters.push_back(std::move(waiter));
+        return true;
+    }
+
+private:
+    std::mutex lock;
+    std::condition_variable done;
+    bool ready;
+    std::exception_ptr error;
+    std::vector<std::function<void()>> waiters;
+};
+
+// Handle to an asynchronous launch. Copies share the launch; a default constructed future has none
+class SIMD_future {
+public:
+    SIMD_future() : engine(nullptr) {}
+    SIMD_future(compute_engine* engine, std::shared_ptr<SIMD_launch_state> state) : engine(engine), state(std::move(state)) {}
+
+    bool valid() const { return state != nullptr; }
+
+    // Whether the launch is done, without blocking
+    bool is_ready() const {
+        check_state();
+        return state->is_ready();
+    }
+
+    // Blocks until the launch is done and rethrows the exception it threw, if any
+    void wait() const {
+        check_state();
+        state->wait();
+    }
+
+    // Queues launch(engine) on the same engine for once this launch is done, and returns its future. Skipped if this launch threw
+    template <typename launch_t>
+    SIMD_future then(launch_t launch) const;
+
+#ifdef SIMD_HAS_COROUTINES
+    struct awaiter {
+        std::shared_ptr<SIMD_launch_state> state;
+
+        bool await_ready() const { return state->is_ready(); }
+        bool await_suspend(std::coroutine_handle<> handle) const { return state->on_ready([handle] { handle.resume(); }); }
+        void await_resume() const { state->wait(); }
+    };
+
+    awaiter operator co_await() const {
+        check_state();
+        return awaiter{ state };
+    }
+#endif
+
+private:
+    void check_state() const {
+        if (!state) {
+            throw std::logic_error("Future has no launch");
+        }
+    }
+
+    compute_engine* engine;
+    std::shared_ptr<SIMD_launch_state> state;
+};
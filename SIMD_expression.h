@@ -0,0 +1,248 @@
+#pragma once
+#include "SIMD_float.h"
+#include <type_traits>
+
+
+/* Lazy expressions over SIMD_vecf.
+
+Every operator on SIMD_vecf evaluates immediately and returns a new vector. Expressions instead build a tree of nodes at compile time
+and only evaluate it when it is assigned to a SIMD_vecf, one vector at a time, with every intermediate kept in a register.
+a * b + c (in either order) is contracted into a single mul_add (FMA) while the tree is built.
+
+Usage:
+SIMD_vecf x(3.0f), y(4.0f);
+SIMD_vecf out = sqrt(lazy(x) * lazy(x) + lazy(y) * lazy(y)); // 5.0f in every lane; x * x + ... becomes one mul_add
+
+Floats and SIMD_vecf values may be mixed into an expression freely; they are copied into the tree. arg<k>() stands for array k of a
+weaved_array, which lets the engine evaluate an expression over whole arrays:
+
+call_SIMD_expression<2, TEST_SIZE>(inputs, 0, sqrt(arg<0>() * arg<0>() + arg<1>() * arg<1>())); // arrays[0] = hypot(arrays[0], arrays[1])
+*/
+template <typename derived_t>
+struct SIMD_expression {
+    const derived_t& self() const {
+        return static_cast<const derived_t&>(*this);
+    }
+
+    // Evaluates the expression. Only expressions containing arg<k>() need arrays and index
+    SIMD_vecf evaluate(SIMD_vecf** arrays = nullptr, size_t index = 0) const {
+        return self().evaluate(arrays, index);
+    }
+
+    operator SIMD_vecf() const {
+        return self().evaluate(nullptr, 0);
+    }
+};
+
+template <typename T>
+struct is_SIMD_expression : std::is_base_of<SIMD_expression<T>, T> {};
+
+/* ------------------------------------------Terminals------------------------------------------ */
+
+// A SIMD_vecf (or broadcast float) copied into the expression
+struct SIMD_value : SIMD_expression<SIMD_value> {
+    SIMD_vecf value;
+
+    SIMD_value(const SIMD_vecf& value) : value(value) {}
+
+    SIMD_vecf evaluate(SIMD_vecf**, size_t) const {
+        return value;
+    }
+
+    static constexpr bool reads(size_t) {
+        return false;
+    }
+};
+
+// Vector index of array k, read when the engine evaluates the expression
+template <size_t k>
+struct SIMD_argument : SIMD_expression<SIMD_argument<k>> {
+    SIMD_vecf evaluate(SIMD_vecf** arrays, size_t index) const {
+        return arrays[k][index];
+    }
+
+    // Whether evaluating the expression reads the given array, so the engine only prefetches those
+    static constexpr bool reads(size_t array) {
+        return array == k;
+    }
+};
+
+// Starts an expression from a SIMD_vecf
+inline SIMD_value lazy(const SIMD_vecf& value) {
+    return SIMD_value(value);
+}
+
+// Placeholder for array k of the weaved_array an expression is evaluated over
+template <size_t k>
+SIMD_argument<k> arg() {
+    return SIMD_argument<k>();
+}
+
+// Expressions are stored by value, everything else that can take part in one is wrapped in a SIMD_value
+template <typename T, bool = is_SIMD_expression<T>::value>
+struct SIMD_operand {
+    typedef T type;
+    static const T& wrap(const T& operand) { return operand; }
+};
+
+template <typename T>
+struct SIMD_operand<T, false> {
+    typedef SIMD_value type;
+    static SIMD_value wrap(const SIMD_vecf& operand) { return SIMD_value(operand); }
+    static SIMD_value wrap(float operand) { return SIMD_value(SIMD_vecf(operand)); }
+};
+
+template <typename T>
+struct is_SIMD_operand : std::integral_constant<bool, is_SIMD_expression<T>::value || std::is_same<T, SIMD_vecf>::value || std::is_arithmetic<T>::value> {};
+
+// Operators are only picked up when at least one side is an expression, so plain SIMD_vecf arithmetic keeps evaluating eagerly
+template <typename L, typename R>
+struct enable_SIMD_binary : std::enable_if<is_SIMD_operand<L>::value && is_SIMD_operand<R>::value &&
+    (is_SIMD_expression<L>::value || is_SIMD_expression<R>::value)> {};
+
+/* --------------------------------------------Nodes-------------------------------------------- */
+
+template <typename op_t, typename operand_t>
+struct SIMD_unary : SIMD_expression<SIMD_unary<op_t, operand_t>> {
+    operand_t operand;
+
+    SIMD_unary(const operand_t& operand) : operand(operand) {}
+
+    SIMD_vecf evaluate(SIMD_vecf** arrays, size_t index) const {
+        return op_t::apply(operand.evaluate(arrays, index));
+    }
+
+    static constexpr bool reads(size_t array) {
+        return operand_t::reads(array);
+    }
+};
+
+template <typename op_t, typename lhs_t, typename rhs_t>
+struct SIMD_binary : SIMD_expression<SIMD_binary<op_t, lhs_t, rhs_t>> {
+    lhs_t lhs;
+    rhs_t rhs;
+
+    SIMD_binary(const lhs_t& lhs, const rhs_t& rhs) : lhs(lhs), rhs(rhs) {}
+
+    SIMD_vecf evaluate(SIMD_vecf** arrays, size_t index) const {
+        return op_t::apply(lhs.evaluate(arrays, index), rhs.evaluate(arrays, index));
+    }
+
+    static constexpr bool reads(size_t array) {
+        return lhs_t::reads(array) || rhs_t::reads(array);
+    }
+};
+
+// multiplier * multiplicand + addend as one FMA
+template <typename multiplier_t, typename multiplicand_t, typename addend_t>
+struct SIMD_mul_add : SIMD_expression<SIMD_mul_add<multiplier_t, multiplicand_t, addend_t>> {
+    multiplier_t multiplier;
+    multiplicand_t multiplicand;
+    addend_t addend;
+
+    SIMD_mul_add(const multiplier_t& multiplier, const multiplicand_t& multiplicand, const addend_t& addend)
+        : multiplier(multiplier), multiplicand(multiplicand), addend(addend) {}
+
+    SIMD_vecf evaluate(SIMD_vecf** arrays, size_t index) const {
+        return multiplier.evaluate(arrays, index).mul_add(multiplicand.evaluate(arrays, index), addend.evaluate(arrays, index));
+    }
+
+    static constexpr bool reads(size_t array) {
+        return multiplier_t::reads(array) || multiplicand_t::reads(array) || addend_t::reads(array);
+    }
+};
+
+namespace SIMD_ops {
+    struct add { static SIMD_vecf apply(const SIMD_vecf& a, const SIMD_vecf& b) { return a + b; } };
+    struct sub { static SIMD_vecf apply(const SIMD_vecf& a, const SIMD_vecf& b) { return a - b; } };
+    struct mul { static SIMD_vecf apply(const SIMD_vecf& a, const SIMD_vecf& b) { return a * b; } };
+    struct div { static SIMD_vecf apply(const SIMD_vecf& a, const SIMD_vecf& b) { return a / b; } };
+    struct pow { static SIMD_vecf apply(SIMD_vecf a, const SIMD_vecf& b) { return a.pow(b); } };
+
+    struct neg { static SIMD_vecf apply(const SIMD_vecf& a) { return -a; } };
+    struct sqrt { static SIMD_vecf apply(const SIMD_vecf& a) { return a.sqrt(); } };
+    struct abs { static SIMD_vecf apply(SIMD_vecf a) { return a.abs(); } };
+    struct floor { static SIMD_vecf apply(SIMD_vecf a) { return a.floor(); } };
+    struct ceil { static SIMD_vecf apply(SIMD_vecf a) { return a.ceil(); } };
+    struct round { static SIMD_vecf apply(SIMD_vecf a) { return a.round(); } };
+    struct exp { static SIMD_vecf apply(SIMD_vecf a) { return a.exp(); } };
+    struct log { static SIMD_vecf apply(const SIMD_vecf& a) { return a.log(); } };
+    struct sin { static SIMD_vecf apply(SIMD_vecf a) { return a.sin(); } };
+    struct cos { static SIMD_vecf apply(SIMD_vecf a) { return a.cos(); } };
+    struct tan { static SIMD_vecf apply(SIMD_vecf a) { return a.tan(); } };
+}
+
+// Builds lhs + rhs, contracting a product on either side into a mul_add
+template <typename lhs_t, typename rhs_t>
+struct SIMD_sum {
+    typedef SIMD_binary<SIMD_ops::add, lhs_t, rhs_t> type;
+    static type make(const lhs_t& lhs, const rhs_t& rhs) { return type(lhs, rhs); }
+};
+
+template <typename a_t, typename b_t, typename rhs_t>
+struct SIMD_sum<SIMD_binary<SIMD_ops::mul, a_t, b_t>, rhs_t> {
+    typedef SIMD_mul_add<a_t, b_t, rhs_t> type;
+    static type make(const SIMD_binary<SIMD_ops::mul, a_t, b_t>& lhs, const rhs_t& rhs) { return type(lhs.lhs, lhs.rhs, rhs); }
+};
+
+template <typename lhs_t, typename a_t, typename b_t>
+struct SIMD_sum<lhs_t, SIMD_binary<SIMD_ops::mul, a_t, b_t>> {
+    typedef SIMD_mul_add<a_t, b_t, lhs_t> type;
+    static type make(const lhs_t& lhs, const SIMD_binary<SIMD_ops::mul, a_t, b_t>& rhs) { return type(rhs.lhs, rhs.rhs, lhs); }
+};
+
+// Both sides are products: contract the left one and keep the right one as the addend
+template <typename a_t, typename b_t, typename c_t, typename d_t>
+struct SIMD_sum<SIMD_binary<SIMD_ops::mul, a_t, b_t>, SIMD_binary<SIMD_ops::mul, c_t, d_t>> {
+    typedef SIMD_mul_add<a_t, b_t, SIMD_binary<SIMD_ops::mul, c_t, d_t>> type;
+    static type make(const SIMD_binary<SIMD_ops::mul, a_t, b_t>& lhs, const SIMD_binary<SIMD_ops::mul, c_t, d_t>& rhs) { return type(lhs.lhs, lhs.rhs, rhs); }
+};
+
+/* ------------------------------------------Operators------------------------------------------ */
+
+template <typename L, typename R, typename = typename enable_SIMD_binary<L, R>::type>
+typename SIMD_sum<typename SIMD_operand<L>::type, typename SIMD_operand<R>::type>::type operator+(const L& lhs, const R& rhs) {
+    return SIMD_sum<typename SIMD_operand<L>::type, typename SIMD_operand<R>::type>::make(SIMD_operand<L>::wrap(lhs), SIMD_operand<R>::wrap(rhs));
+}
+
+template <typename L, typename R, typename = typename enable_SIMD_binary<L, R>::type>
+SIMD_binary<SIMD_ops::sub, typename SIMD_operand<L>::type, typename SIMD_operand<R>::type> operator-(const L& lhs, const R& rhs) {
+    return SIMD_binary<SIMD_ops::sub, typename SIMD_operand<L>::type, typename SIMD_operand<R>::type>(SIMD_operand<L>::wrap(lhs), SIMD_operand<R>::wrap(rhs));
+}
+
+template <typename L, typename R, typename = typename enable_SIMD_binary<L, R>::type>
+SIMD_binary<SIMD_ops::mul, typename SIMD_operand<L>::type, typename SIMD_operand<R>::type> operator*(const L& lhs, const R& rhs) {
+    return SIMD_binary<SIMD_ops::mul, typename SIMD_operand<L>::type, typename SIMD_operand<R>::type>(SIMD_operand<L>::wrap(lhs), SIMD_operand<R>::wrap(rhs));
+}
+
+template <typename L, typename R, typename = typename enable_SIMD_binary<L, R>::type>
+SIMD_binary<SIMD_ops::div, typename SIMD_operand<L>::type, typename SIMD_operand<R>::type> operator/(const L& lhs, const R& rhs) {
+    return SIMD_binary<SIMD_ops::div, typename SIMD_operand<L>::type, typename SIMD_operand<R>::type>(SIMD_operand<L>::wrap(lhs), SIMD_operand<R>::wrap(rhs));
+}
+
+template <typename L, typename R, typename = typename enable_SIMD_binary<L, R>::type>
+SIMD_binary<SIMD_ops::pow, typename SIMD_operand<L>::type, typename SIMD_operand<R>::type> pow(const L& base, const R& exponent) {
+    return SIMD_binary<SIMD_ops::pow, typename SIMD_operand<L>::type, typename SIMD_operand<R>::type>(SIMD_operand<L>::wrap(base), SIMD_operand<R>::wrap(exponent));
+}
+
+template <typename E>
+SIMD_unary<SIMD_ops::neg, E> operator-(const SIMD_expression<E>& operand) {
+    return SIMD_unary<SIMD_ops::neg, E>(operand.self());
+}
+
+// a * b + c spelled out; useful when the product and the sum are built in different places
+template <typename A, typename B, typename C>
+SIMD_mul_add<typename SIMD_operand<A>::type, typename SIMD_operand<B>::type, typename SIMD_operand<C>::type> mul_add(const A& a, const B& b, const C& c) {
+    return SIMD_mul_add<typename SIMD_operand<A>::type, typename SIMD_operand<B>::type, typename SIMD_operand<C>::type>(SIMD_operand<A>::wrap(a), SIMD_operand<B>::wrap(b), SIMD_operand<C>::wrap(c));
+}
+
+template <typename E> SIMD_unary<SIMD_ops::sqrt, E> sqrt(const SIMD_expression<E>& operand) { return SIMD_unary<SIMD_ops::sqrt, E>(operand.self()); }
+template <typename E> SIMD_unary<SIMD_ops::abs, E> abs(const SIMD_expression<E>& operand) { return SIMD_unary<SIMD_ops::abs, E>(operand.self()); }
+template <typename E> SIMD_unary<SIMD_ops::floor, E> floor(const SIMD_expression<E>& operand) { return SIMD_unary<SIMD_ops::floor, E>(operand.self()); }
+template <typename E> SIMD_unary<SIMD_ops::ceil, E> ceil(const SIMD_expression<E>& operand) { return SIMD_unary<SIMD_ops::ceil, E>(operand.self()); }
+template <typename E> SIMD_unary<SIMD_ops::round, E> round(const SIMD_expression<E>& operand) { return SIMD_unary<SIMD_ops::round, E>(operand.self()); }
+template <typename E> SIMD_unary<SIMD_ops::exp, E> exp(const SIMD_expression<E>& operand) { return SIMD_unary<SIMD_ops::exp, E>(operand.self()); }
+template <typename E> SIMD_unary<SIMD_ops::log, E> log(const SIMD_expression<E>& operand) { return SIMD_unary<SIMD_ops::log, E>(operand.self()); }
+template <typename E> SIMD_unary<SIMD_ops::sin, E> sin(const SIMD_expression<E>& operand) { return SIMD_unary<SIMD_ops::sin, E>(operand.self()); }
+template <typename E> SIMD_unary<SIMD_ops::cos, E> cos(const SIMD_expression<E>& operand) { return SIMD_unary<SIMD_ops::cos, E>(operand.self()); }
+template <typename E> SIMD_unary<SIMD_ops::tan, E> tan(const SIMD_expression<E>& operand) { return SIMD_unary<SIMD_ops::tan, E>(operand.self()); }
@@ -0,0 +1,60 @@
+#pragma once
+#include "SIMD_float.h"
+
+
+/* Producers for compute_engine's fill operations.
+
+A fill writes one array of a weaved_array without reading it: every worker asks the producer for the vectors of its range and stores
+them. A producer is called as produce(value, first_element) and sets value to elements first_element to first_element + width - 1.
+For the last, partial vector of an array it is still asked for a whole vector, and only the lanes inside the array are stored.
+
+Fills of large arrays use non-temporal stores (see SIMD_store_mode in compute_engine.h), which skip reading each cache line before
+overwriting it and don't evict what the caches hold, so filling runs at memory write bandwidth.
+
+Usage:
+compute_engine engine;
+engine.fill_constant(inputs, 0, 1.0f);                 // arrays[0][i] = 1
+engine.fill_ramp(inputs, 1, 0.0f, 0.5f);               // arrays[1][i] = 0.5 * i
+engine.fill_copy(inputs, 2, samples.data());           // arrays[2][i] = samples[i]
+engine.fill_generate(inputs, 3, [](auto& value, size_t first) { value = std::decay_t<decltype(value)>(static_cast<float>(first % 7)); });
+*/
+namespace SIMD_fills {
+
+    struct constant {
+        float value;
+
+        template <typename vec_t>
+        void operator()(vec_t& result, size_t) const {
+            result = vec_t(value);
+        }
+    };
+
+    // start + i * step. The vector's first element is computed in double, so large indices don't lose the ramp's low bits
+    struct ramp {
+        float start;
+        float step;
+
+        template <typename vec_t>
+        void operator()(vec_t& result, size_t first_element) const {
+            static const float lanes[16] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f };
+            float first = static_cast<float>(start + static_cast<double>(first_element) * step);
+            result = vec_t(first) + vec_t(lanes) * vec_t(step);
+        }
+    };
+
+    // source[i] for the size elements of source. The last vector is loaded masked, so nothing past source[size - 1] is read
+    struct copy {
+        const float* source;
+        size_t size;
+
+        template <typename vec_t>
+        void operator()(vec_t& result, size_t first_element) const {
+            if (size - first_element >= vec_t::width) {
+                result = vec_t(source + first_element);
+            }
+            else {
+                result = vec_t::load_partial(source + first_element, size - first_element);
+            }
+        }
+    };
+}
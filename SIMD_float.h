@@ -1,15 +1,155 @@
+#pragma once
+#include "SIMD_float_128.h" // SIMD_128::SIMD_vecf, SSE4.1
+#include "SIMD_float_256.h" // SIMD_256::SIMD_vecf, AVX2 + FMA
+#include "SIMD_float_512.h" // SIMD_512::SIMD_vecf, AVX-512F
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// SIMD_vecf is the widest backend the compiler flags enable for the whole build. Kernels written against it run at that width
+// everywhere; kernels written for any width (see compute_engine.h) are dispatched to the widest backend the CPU supports at run time.
 #if defined(__AVX512F__)
-#include "SIMD_float_512.h" // Header for AVX-512 intrinsics
+namespace SIMD_native = SIMD_512; // Header for AVX-512 intrinsics
 #elif defined(__AVX2__)
-#include "SIMD_float_256.h" // Header for AVX2 intrinsics
+namespace SIMD_native = SIMD_256; // Header for AVX2 intrinsics
 #elif defined(__AVX__)
-#include "SIMD_float_256.h" // Header for AVX intrinsics
+namespace SIMD_native = SIMD_256; // Header for AVX intrinsics
 #elif defined(_M_IX86_FP) && _M_IX86_FP == 2
-#include "SIMD_float_128.h" // Header for SSE2 intrinsics
+namespace SIMD_native = SIMD_128; // Header for SSE2 intrinsics
 #elif defined(_M_IX86_FP) && _M_IX86_FP == 1
-#include "SIMD_float_128.h" // Header for SSE intrinsics
-#elif defined(_M_X64)
-#include "SIMD_float_128.h" // SSE2 support is implied for x64
+namespace SIMD_native = SIMD_128; // Header for SSE intrinsics
+#elif defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+namespace SIMD_native = SIMD_128; // SSE2 support is implied for x64
 #else
 #error "No SIMD support detected. Ensure your compiler supports at least SSE."
-#endif
\ No newline at end of file
+#endif
+
+typedef SIMD_native::SIMD_vecf SIMD_vecf;
+typedef SIMD_native::SIMD_maskf SIMD_maskf;
+
+#define SIMD_VECTOR_SIZE SIMD_vecf::width
+
+// Floats in the widest vector any backend uses. Arrays are padded and aligned to this so every backend can process them
+#define SIMD_MAX_VECTOR_SIZE 16
+
+
+/* ----------------------------------------Runtime dispatch---------------------------------------- */
+
+enum class SIMD_backend {
+    sse = 128,
+    avx2 = 256,
+    avx512 = 512
+};
+
+inline const char* SIMD_backend_name(SIMD_backend backend) {
+    switch (backend) {
+    case SIMD_backend::avx512: return "AVX-512";
+    case SIMD_backend::avx2: return "AVX2";
+    default: return "SSE";
+    }
+}
+
+namespace SIMD_detail {
+    inline void cpuid(int info[4], int leaf, int subleaf) {
+#if defined(_MSC_VER)
+        __cpuidex(info, leaf, subleaf);
+#else
+        unsigned int a, b, c, d;
+        __cpuid_count(leaf, subleaf, a, b, c, d);
+        info[0] = static_cast<int>(a);
+        info[1] = static_cast<int>(b);
+        info[2] = static_cast<int>(c);
+        info[3] = static_cast<int>(d);
+#endif
+    }
+
+    // Which register states the OS saves on a context switch. A CPU with AVX under an OS that doesn't save ymm can't use it
+    inline unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int low, high;
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return (static_cast<unsigned long long>(high) << 32) | low;
+#endif
+    }
+}
+
+// The widest backend this CPU and OS support. Even the SSE backend uses SSE4.1 (blends, rounding, byte shuffles), and there is no
+// scalar one to fall back to, so a CPU without it gets std::runtime_error rather than an illegal instruction later on
+inline SIMD_backend detect_SIMD_backend() {
+    int info[4];
+    SIMD_detail::cpuid(info, 0, 0);
+    int max_leaf = info[0];
+
+    SIMD_detail::cpuid(info, 1, 0);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    if (!sse41) {
+        throw std::runtime_error("This CPU lacks SSE4.1, which every SIMD backend needs");
+    }
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || !fma || max_leaf < 7) {
+        return SIMD_backend::sse;
+    }
+
+    unsigned long long xcr0 = SIMD_detail::xgetbv0();
+    if ((xcr0 & 0x6) != 0x6) { // xmm and ymm state
+        return SIMD_backend::sse;
+    }
+
+    SIMD_detail::cpuid(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    bool avx512f = (info[1] & (1 << 16)) != 0;
+    if (!avx2) {
+        return SIMD_backend::sse;
+    }
+    if (avx512f && (xcr0 & 0xE0) == 0xE0) { // opmask and zmm state
+        return SIMD_backend::avx512;
+    }
+    return SIMD_backend::avx2;
+}
+
+// The backend dispatched kernels run on: detect_SIMD_backend(), unless COMPUTE_ENGINE_SIMD (sse, avx2 or avx512) asks for a
+// narrower one. Asking for a wider one than the CPU has keeps the detected backend; unset or empty means no override. Decided once,
+// the first time it is needed; throws std::runtime_error on a CPU without SSE4.1, as detection does, and on any other value.
+inline SIMD_backend SIMD_backend_in_use() {
+    static const SIMD_backend backend = [] {
+        SIMD_backend detected = detect_SIMD_backend();
+#if defined(__GNUC__) && !defined(__OPTIMIZE__)
+        // Unoptimized GCC and Clang builds ignore SIMD_FLATTEN, so every call a kernel makes would hand vectors wider than the build's
+        // to functions compiled without the instructions for them: crashes on AVX-512, wrong results on AVX2. Debug builds stay at
+        // SIMD_vecf's width instead
+        SIMD_backend native = static_cast<SIMD_backend>(SIMD_vecf::width * 32);
+        detected = static_cast<int>(native) < static_cast<int>(detected) ? native : detected;
+#endif
+        const char* requested = std::getenv("COMPUTE_ENGINE_SIMD");
+        if (requested == nullptr || requested[0] == '\0') {
+            return detected;
+        }
+
+        SIMD_backend choice;
+        if (std::strcmp(requested, "sse") == 0) {
+            choice = SIMD_backend::sse;
+        }
+        else if (std::strcmp(requested, "avx2") == 0) {
+            choice = SIMD_backend::avx2;
+        }
+        else if (std::strcmp(requested, "avx512") == 0) {
+            choice = SIMD_backend::avx512;
+        }
+        else {
+            throw std::runtime_error(std::string("COMPUTE_ENGINE_SIMD is \"") + requested + "\", expected sse, avx2 or avx512");
+        }
+        return static_cast<int>(choice) < static_cast<int>(detected) ? choice : detected;
+    }();
+    return backend;
+}
@@ -3,19 +3,196 @@
 #include <array>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include "SIMD_target.h"
+#include "SIMD_accuracy.h"
+
+SIMD_TARGET_BEGIN_SSE
+namespace SIMD_128 {
+
+/* -------------------------Math primitives------------------------ */
+// The operations SIMD_math.inl is written against, so the same transcendental code compiles for every backend
+namespace math {
+    typedef __m128 vfloat;
+    typedef __m128i vint;
+    typedef __m128 vmask; // all ones in true lanes
+
+    inline vfloat vset(float x) { return _mm_set1_ps(x); }
+    inline vint vseti(int x) { return _mm_set1_epi32(x); }
+
+    inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+    inline vfloat vsub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+    inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+    inline vfloat vdiv(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+    inline vfloat vfma(vfloat a, vfloat b, vfloat c) { return _mm_add_ps(_mm_mul_ps(a, b), c); } // not fused: no FMA on SSE
+    // The rounding error of p = a * b, exactly. Without FMA, by splitting a and b into 12 bit halves whose products are exact
+    inline vfloat vprod_error(vfloat a, vfloat b, vfloat p) {
+        const __m128 splitter = _mm_set1_ps(4097.0f);
+        __m128 ca = _mm_mul_ps(a, splitter);
+        __m128 a_hi = _mm_sub_ps(ca, _mm_sub_ps(ca, a));
+        __m128 a_lo = _mm_sub_ps(a, a_hi);
+        __m128 cb = _mm_mul_ps(b, splitter);
+        __m128 b_hi = _mm_sub_ps(cb, _mm_sub_ps(cb, b));
+        __m128 b_lo = _mm_sub_ps(b, b_hi);
+        __m128 error = _mm_sub_ps(_mm_mul_ps(a_hi, b_hi), p);
+        error = _mm_add_ps(error, _mm_mul_ps(a_hi, b_lo));
+        error = _mm_add_ps(error, _mm_mul_ps(a_lo, b_hi));
+        return _mm_add_ps(error, _mm_mul_ps(a_lo, b_lo));
+    }
+    inline vfloat vsqrt(vfloat a) { return _mm_sqrt_ps(a); }
+    // Estimates good to 12 bits
+    inline vfloat vrcp(vfloat a) { return _mm_rcp_ps(a); }
+    inline vfloat vrsqrt(vfloat a) { return _mm_rsqrt_ps(a); }
+    inline vfloat vmin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+    inline vfloat vmax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+    inline vfloat vround(vfloat a) { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    inline vfloat vtrunc(vfloat a) { return _mm_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+
+    inline vfloat vand_bits(vfloat a, vfloat b) { return _mm_and_ps(a, b); }
+    inline vfloat vor_bits(vfloat a, vfloat b) { return _mm_or_ps(a, b); }
+    inline vfloat vxor_bits(vfloat a, vfloat b) { return _mm_xor_ps(a, b); }
+    inline vfloat vandnot_bits(vfloat a, vfloat b) { return _mm_andnot_ps(a, b); } // ~a & b
+    inline vfloat vabs(vfloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    inline vfloat vneg(vfloat a) { return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+
+    inline vmask vlt(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+    inline vmask vgt(vfloat a, vfloat b) { return _mm_cmpgt_ps(a, b); }
+    inline vmask vge(vfloat a, vfloat b) { return _mm_cmpge_ps(a, b); }
+    inline vmask veq(vfloat a, vfloat b) { return _mm_cmpeq_ps(a, b); }
+    inline vmask vneq(vfloat a, vfloat b) { return _mm_cmpneq_ps(a, b); }
+    inline vmask vand_m(vmask a, vmask b) { return _mm_and_ps(a, b); }
+    inline vmask vor_m(vmask a, vmask b) { return _mm_or_ps(a, b); }
+    inline vmask vandnot_m(vmask a, vmask b) { return _mm_andnot_ps(a, b); } // !a && b
+    inline vmask vnot_m(vmask a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+    // if_true where the mask is set, if_false elsewhere
+    inline vfloat vselect(vmask mask, vfloat if_true, vfloat if_false) { return _mm_blendv_ps(if_false, if_true, mask); }
+
+    inline vint vcvt_round(vfloat a) { return _mm_cvtps_epi32(a); }
+    inline vint vcvt_trunc(vfloat a) { return _mm_cvttps_epi32(a); }
+    inline vfloat vcvt_float(vint a) { return _mm_cvtepi32_ps(a); }
+    inline vfloat vas_float(vint a) { return _mm_castsi128_ps(a); }
+    inline vint vas_int(vfloat a) { return _mm_castps_si128(a); }
+
+    inline vint vaddi(vint a, vint b) { return _mm_add_epi32(a, b); }
+    inline vint vsubi(vint a, vint b) { return _mm_sub_epi32(a, b); }
+    inline vint vandi(vint a, vint b) { return _mm_and_si128(a, b); }
+    inline vint vori(vint a, vint b) { return _mm_or_si128(a, b); }
+    inline vint vxori(vint a, vint b) { return _mm_xor_si128(a, b); }
+    template <int bits> inline vint vshli(vint a) { return _mm_slli_epi32(a, bits); }
+    template <int bits> inline vint vsrli(vint a) { return _mm_srli_epi32(a, bits); }
+    template <int bits> inline vint vsrai(vint a) { return _mm_srai_epi32(a, bits); }
+    inline vmask veqi(vint a, vint b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+} // namespace math
+
+#include "SIMD_math.inl"
+
+
+
+/* The result of comparing SIMD_vecfs: one bool per lane, kept as the raw compare bits (all ones or all zeroes per lane) instead of the 1.0f / 0.0f floats
+comparisons used to return, so branchless code can select() on it directly. The float form is still there by converting: SIMD_vecf(x < y).
 
-#define SIMD_VECTOR_SIZE 4
+Usage:
+SIMD_maskf inside = (x > -5.0f) & (x < 5.0f);
+x = select(inside, x * x, x); // Squares the elements between -5 and 5
+if (inside.none()) { ... }
+*/
+struct SIMD_maskf {
+    __m128 data;
+
+    // Lanes per mask
+    static const size_t width = 4;
+
+    // Basic constructor, doesn't initialize the data
+    SIMD_maskf() {}
+
+    // Sets every lane to value
+    explicit SIMD_maskf(bool value) : data(_mm_castsi128_ps(_mm_set1_epi32(value ? -1 : 0))) {}
 
+    // Set in the first count (<= 4) lanes, clear in the rest
+    static SIMD_maskf first(size_t count) {
+        return SIMD_maskf(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int>(count)), _mm_setr_epi32(0, 1, 2, 3))));
+    }
+
+    // Lane-wise AND
+    SIMD_maskf operator&(const SIMD_maskf& other) const {
+        return SIMD_maskf(_mm_and_ps(data, other.data));
+    }
 
+    // Lane-wise OR
+    SIMD_maskf operator|(const SIMD_maskf& other) const {
+        return SIMD_maskf(_mm_or_ps(data, other.data));
+    }
 
+    // Lane-wise XOR
+    SIMD_maskf operator^(const SIMD_maskf& other) const {
+        return SIMD_maskf(_mm_xor_ps(data, other.data));
+    }
+
+    // Lane-wise NOT
+    SIMD_maskf operator~() const {
+        return SIMD_maskf(_mm_xor_ps(data, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+    }
+
+    // this = this & other
+    SIMD_maskf& operator&=(const SIMD_maskf& other) {
+        data = _mm_and_ps(data, other.data);
+        return *this;
+    }
+
+    // this = this | other
+    SIMD_maskf& operator|=(const SIMD_maskf& other) {
+        data = _mm_or_ps(data, other.data);
+        return *this;
+    }
+
+    // One bit per lane, lane 0 in the lowest bit
+    int bits() const {
+        return _mm_movemask_ps(data);
+    }
+
+    // True if any lane is set
+    bool any() const {
+        return bits() != 0;
+    }
+
+    // True if every lane is set
+    bool all() const {
+        return bits() == 0xF;
+    }
+
+    // True if no lane is set
+    bool none() const {
+        return bits() == 0;
+    }
+
+    // Number of lanes set
+    int popcount() const {
+        unsigned int count = static_cast<unsigned int>(bits());
+        count = count - ((count >> 1) & 0x5555);
+        count = (count & 0x3333) + ((count >> 2) & 0x3333);
+        count = (count + (count >> 4)) & 0x0F0F;
+        return static_cast<int>((count + (count >> 8)) & 0x1F);
+    }
+
+    // Whether lane index is set
+    bool operator[](size_t index) const {
+        return ((bits() >> index) & 1) != 0;
+    }
+
+private:
+    // Private Constructor to initialize with raw compare results. Private for a consistent interface
+    explicit SIMD_maskf(__m128 compare_result) : data(compare_result) {}
+
+    friend struct SIMD_vecf;
+};
 
 
 /* Abstract SIMD float vector type. The size of the vector varies based on what the CPU you are compiling for can handle.
-For machines with AVX-512 support, this will store a __m128512 and call the appropriate operands.
-For machines with only AVX2, this will store a __m128. SSE2? __m128. No support? Defaults to float.
+For machines with AVX-512 support, this will store a __m512 and call the appropriate operands.
+For machines with only AVX2, this will store a __m256. SSE2? __m128. No support? Defaults to float.
 
 Since this is meant to be an abstraction for use in parallelized systems, all operations are executed using the appropriate instruction for their vector size.
-For high-end machines, pow() executes _mm512_pow_ps on the underlying __m128512, but on an old PC without SIMD support, pow() is just the standard C implementation, no SIMD tricks.
+For high-end machines, pow() runs the vectorized code in SIMD_math.inl on the underlying __m512, but on an old PC without SIMD support, pow() is just the standard C implementation, no SIMD tricks.
 
 send a function pointer to the driver, and have it run your task using SIMD (if available) on as many cores as the CPU can handle.
 
@@ -27,6 +204,7 @@ SIMD_vecf y = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f}; // specify each
 SIMD_vecf mask = (y < 5); // Compares each element of y to 5. 1.0f if true, 0.0f otherwise.
 y += 3.0; // Add 3.0 to each element of y
 std::cout << y; // print y
+float total = y.hsum(); // Adds up the lanes of y
 y.inline_pow(mask + 1.0f); // For any element < 5, it squares it, otherwise, it stays the same.
 
 On its own, this is pretty useless, however, the power becomes clear when you create peice-wise functions and pass a pointer to the function to the compute engine.
@@ -35,14 +213,23 @@ Performance tips:
 Try to use the inline variants of every function if at all possible. Instead of returning the expression, it just changes the calling instance's data instead of returning an altered copy.
 In a single call, this is nigh meaningless, but at scale, it's incredibly detrimental to the performance of your application.
 
+If a power is a whole number (or a half) known at compile time, use x.inline_pow<2>() or x.inline_pow<3, 2>() over x.inline_pow(2.0f). They
+compile to a few multiplies (and a sqrt), where pow() with an arbitrary exponent takes a log and an exp.
+
 Another suggested method is to partition your data in such a way so that it's as contiguous as possible. If you have two arrays, X, and Y, the last element of X should touch the first element of Y.
 This makes cache happy and reduces the amount of reads / writes to disk we perform, which is often the largest bottleneck in computing - memory bandwidth
 
-You should also stay away from branching. If you need conditional computation, use the select() method. It takes in the output if(true), and the output if(false), as well as a mask
+You should also stay away from branching. If you need conditional computation, use select(mask, if_true, if_false) with the SIMD_maskf a comparison returns
 */
 struct SIMD_vecf {
     __m128 data;
 
+    // Floats per vector
+    static const size_t width = 4;
+
+    // What the comparison operators return
+    typedef SIMD_maskf mask_type;
+
 
     /* --------------------------------CONSTRUCTORS------------------------------------*/
 
@@ -52,6 +239,9 @@ struct SIMD_vecf {
     // Initialize a SIMD_vecf from a float. Copies initial_data in every slot
     SIMD_vecf(float initial_data) : data(_mm_set1_ps(initial_data)) {}
 
+    // 1.0f in the lanes where mask is set and 0.0f in the rest, the form comparisons returned before SIMD_maskf
+    SIMD_vecf(const SIMD_maskf& mask) : data(_mm_and_ps(mask.data, _mm_set1_ps(1.0f))) {}
+
 
     // Constructor to initialize with std::initializer_list
     SIMD_vecf(std::initializer_list<float> init_list) {
@@ -73,13 +263,53 @@ struct SIMD_vecf {
 
     // Gets a vector of ones
     SIMD_vecf ones() const {
-        return SIMD_vecf(constants[1]);
+        return SIMD_vecf(_mm_set1_ps(1.0f));
 
     }
 
     // Gets a vector of zeroes
     SIMD_vecf zeroes() const {
-        return SIMD_vecf(constants[5]);
+        return SIMD_vecf(_mm_setzero_ps());
+    }
+
+    /* ---------------------------Partial loads and stores---------------------------- */
+
+    // Loads the first count (< 4) floats from source and zeroes the remaining lanes. Never reads past source[count - 1]
+    static SIMD_vecf load_partial(const float* source, size_t count) {
+        switch (count) {
+        case 1:
+            return SIMD_vecf(_mm_load_ss(source));
+        case 2:
+            return SIMD_vecf(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(source))));
+        case 3:
+            return SIMD_vecf(_mm_movelh_ps(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(source))), _mm_load_ss(source + 2)));
+        default:
+            return SIMD_vecf(_mm_setzero_ps());
+        }
+    }
+
+    // Stores the first count (< 4) lanes to destination. Never writes past destination[count - 1]
+    void store_partial(float* destination, size_t count) const {
+        switch (count) {
+        case 1:
+            _mm_store_ss(destination, data);
+            break;
+        case 2:
+            _mm_storel_pi(reinterpret_cast<__m64*>(destination), data);
+            break;
+        case 3:
+            _mm_storel_pi(reinterpret_cast<__m64*>(destination), data);
+            _mm_store_ss(destination + 2, _mm_movehl_ps(data, data));
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Stores to destination, which must be aligned to a whole vector, with a non-temporal store that bypasses the caches. The store is
+    // weakly ordered: other threads are only guaranteed to see it after this thread runs _mm_sfence()
+    void store_stream(float* destination) const {
+        _mm_stream_ps(destination, data);
     }
 
     /* -----------------------Arithmetic w/SIMD_vecf-------------------------- */
@@ -105,7 +335,7 @@ struct SIMD_vecf {
     }
 
     SIMD_vecf operator%(const SIMD_vecf& other) const {
-        return SIMD_vecf(_mm_fmod_ps(data, other.data));
+        return SIMD_vecf(math::fmod(data, other.data));
     }
 
     /* -------------------- Arithmetic with standard 32-bit float -------------------- */
@@ -137,7 +367,7 @@ struct SIMD_vecf {
 
     SIMD_vecf operator%(const float& other) const {
         __m128 vector = _mm_set1_ps(other);
-        return SIMD_vecf(_mm_fmod_ps(data, vector));
+        return SIMD_vecf(math::fmod(data, vector));
     }
 
     SIMD_vecf operator-() const {
@@ -172,7 +402,7 @@ struct SIMD_vecf {
     }
 
     SIMD_vecf& operator%=(const SIMD_vecf& other) {
-        data = _mm_fmod_ps(data, other.data);
+        data = math::fmod(data, other.data);
         return *this;
 
     }
@@ -214,7 +444,7 @@ struct SIMD_vecf {
 
     SIMD_vecf& operator%=(const float& other) {
         __m128 vector = _mm_set1_ps(other);
-        data = _mm_fmod_ps(data, vector);
+        data = math::fmod(data, vector);
         return *this;
     }
 
@@ -222,86 +452,268 @@ struct SIMD_vecf {
 
     // Returns this ^ Y
     SIMD_vecf pow(const SIMD_vecf& Y) {
-        return SIMD_vecf(_mm_pow_ps(data, Y.data));
+        return SIMD_vecf(math::pow(data, Y.data));
     }
 
     // this = this ^ Y
     void inline_pow(const SIMD_vecf& Y) {
-        data = _mm_pow_ps(data, Y.data);
+        data = math::pow(data, Y.data);
     }
 
-    //  Constructs a vector where every element is y and returns this ^ y.
+    // Returns this ^ y. Whole y from -4 to 4 is multiplied out instead of going through log and exp
     SIMD_vecf pow(const float y) {
-        __m128 Y = _mm_set1_ps(y);
-        return SIMD_vecf(_mm_pow_ps(data, Y));
+        return SIMD_vecf(math::pow(data, y));
     }
 
-    // Constructs a vector where every element is y and sets this = this ^ y.
+    // Sets this = this ^ y. Whole y from -4 to 4 is multiplied out instead of going through log and exp
     void inline_pow(const float y) {
-        __m128 Y = _mm_set1_ps(y);
-        data = _mm_pow_ps(data, Y);
+        data = math::pow(data, y);
+    }
+
+    // Returns this ^ (N / D), D = 1 or 2, as a chain of multiplies built at compile time. pow<3>() is x * x * x,
+    // pow<-2>() is 1 / (x * x) and pow<3, 2>() is x * sqrt(x)
+    template <int N, int D = 1>
+    SIMD_vecf pow() const {
+        return SIMD_vecf(math::pow<N, D>(data));
+    }
+
+    // this = this ^ (N / D), D = 1 or 2, as a chain of multiplies built at compile time
+    template <int N, int D = 1>
+    void inline_pow() {
+        data = math::pow<N, D>(data);
     }
 
     // Computes the natural log of each element
     SIMD_vecf log() const {
-        return SIMD_vecf(_mm_log_ps(data));
+        return SIMD_vecf(math::log(data));
     }
     // this = log (this)
     void inline_log() {
-        data = _mm_log_ps(data);
+        data = math::log(data);
     }
 
     // Returns log2(this)
     SIMD_vecf log2() const {
-        return SIMD_vecf(_mm_log2_ps(data));
+        return SIMD_vecf(math::log2(data));
     }
     // this = log2(this)
     void inline_log2() {
-        data = _mm_log2_ps(data);
+        data = math::log2(data);
     }
 
     // Returns log10(this)
     SIMD_vecf log10() const {
-        return SIMD_vecf(_mm_log2_ps(data));
+        return SIMD_vecf(math::log10(data));
     }
     // This = log10(this)
     void inline_log10() {
-        data = _mm_log2_ps(data);
+        data = math::log10(data);
     }
 
     // Returns exp(this)
     SIMD_vecf exp()
     {
-        return SIMD_vecf(_mm_exp_ps(data));
+        return SIMD_vecf(math::exp(data));
     }
     // this = exp(this)
     void inline_exp()
     {
-        data = _mm_exp_ps(data);
+        data = math::exp(data);
     }
 
     // Returns exp2(this)
     SIMD_vecf exp2()
     {
-        return SIMD_vecf(_mm_exp2_ps(data));
+        return SIMD_vecf(math::exp2(data));
     }
 
     // this = exp2(this)
     void inline_exp2()
     {
-        data = _mm_exp2_ps(data);
+        data = math::exp2(data);
     }
 
     // Returns exp10(this)
     SIMD_vecf exp10()
     {
-        return SIMD_vecf(_mm_exp10_ps(data));
+        return SIMD_vecf(math::exp10(data));
     }
 
     // this = exp10(this)
     void inline_exp10()
     {
-        data = _mm_exp10_ps(data);
+        data = math::exp10(data);
+    }
+
+    /* ---------------------------------Accuracy tiers---------------------------------------*/
+    // Each takes SIMD_fast, SIMD_standard or SIMD_precise as its last argument. See SIMD_accuracy.h
+
+    // Returns this ^ Y at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf pow(const SIMD_vecf& Y, accuracy_t tier) const {
+        return SIMD_vecf(math::pow(data, Y.data, tier));
+    }
+    // this = this ^ Y at the given accuracy
+    template <typename accuracy_t>
+    void inline_pow(const SIMD_vecf& Y, accuracy_t tier) {
+        data = math::pow(data, Y.data, tier);
+    }
+
+    // Returns e ^ this at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf exp(accuracy_t tier) const {
+        return SIMD_vecf(math::exp(data, tier));
+    }
+    // this = e ^ this at the given accuracy
+    template <typename accuracy_t>
+    void inline_exp(accuracy_t tier) {
+        data = math::exp(data, tier);
+    }
+
+    // Returns log(this) at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf log(accuracy_t tier) const {
+        return SIMD_vecf(math::log(data, tier));
+    }
+    // this = log(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_log(accuracy_t tier) {
+        data = math::log(data, tier);
+    }
+
+    // Returns sin(this) at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf sin(accuracy_t tier) const {
+        return SIMD_vecf(math::sin(data, tier));
+    }
+    // this = sin(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_sin(accuracy_t tier) {
+        data = math::sin(data, tier);
+    }
+
+    // Returns the square root at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf sqrt(accuracy_t tier) const {
+        return SIMD_vecf(math::sqrt(data, tier));
+    }
+    // this = sqrt(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_sqrt(accuracy_t tier) {
+        data = math::sqrt(data, tier);
+    }
+
+    // Returns 1 / this
+    SIMD_vecf rcp() const {
+        return rcp(SIMD_precise);
+    }
+    // this = 1 / this
+    void inline_rcp() {
+        inline_rcp(SIMD_precise);
+    }
+    // Returns 1 / this at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf rcp(accuracy_t tier) const {
+        return SIMD_vecf(math::rcp(data, tier));
+    }
+    // this = 1 / this at the given accuracy
+    template <typename accuracy_t>
+    void inline_rcp(accuracy_t tier) {
+        data = math::rcp(data, tier);
+    }
+
+    // Returns 1 / sqrt(this)
+    SIMD_vecf rsqrt() const {
+        return rsqrt(SIMD_precise);
+    }
+    // this = 1 / sqrt(this)
+    void inline_rsqrt() {
+        inline_rsqrt(SIMD_precise);
+    }
+    // Returns 1 / sqrt(this) at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf rsqrt(accuracy_t tier) const {
+        return SIMD_vecf(math::rsqrt(data, tier));
+    }
+    // this = 1 / sqrt(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_rsqrt(accuracy_t tier) {
+        data = math::rsqrt(data, tier);
+    }
+
+    /* -----------------------------------------Cross-lane------------------------------------------*/
+    // Lanes are numbered from the low end of the register, the order the initializer list constructor fills them in
+
+    // Sum of every lane
+    float hsum() const {
+        __m128 pairs = _mm_add_ps(data, _mm_movehl_ps(data, data));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehdup_ps(pairs)));
+    }
+
+    // Smallest lane. Unspecified if any lane is NaN
+    float hmin() const {
+        __m128 pairs = _mm_min_ps(data, _mm_movehl_ps(data, data));
+        return _mm_cvtss_f32(_mm_min_ss(pairs, _mm_movehdup_ps(pairs)));
+    }
+
+    // Largest lane. Unspecified if any lane is NaN
+    float hmax() const {
+        __m128 pairs = _mm_max_ps(data, _mm_movehl_ps(data, data));
+        return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_movehdup_ps(pairs)));
+    }
+
+    // Lane i of the result is lane i<n> of this. permute<3, 2, 1, 0>() reverses the lanes
+    template <int i0, int i1, int i2, int i3>
+    SIMD_vecf permute() const {
+        static_assert((i0 | i1 | i2 | i3) >= 0 && (i0 | i1 | i2 | i3) < 4, "lanes are 0 to 3");
+        return SIMD_vecf(_mm_shuffle_ps(data, data, _MM_SHUFFLE(i3, i2, i1, i0)));
+    }
+
+    // Lane i of the result is lane (i + n) mod 4 of this. rotate<1>() moves every lane down one, lane 0 to the top
+    template <int n>
+    SIMD_vecf rotate() const {
+        const int r = (n % 4 + 4) % 4;
+        return permute<r, (r + 1) % 4, (r + 2) % 4, (r + 3) % 4>();
+    }
+
+    // Lane i of the result is lane i - n of this, or 0.0f for i < n
+    template <int n>
+    SIMD_vecf shift_up() const {
+        static_assert(n >= 0 && n < 4, "shifts are 0 to 3 lanes");
+        return SIMD_vecf(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(data), 4 * n)));
+    }
+
+    // Lane i of the result is lane i + n of this, or 0.0f for i >= 4 - n
+    template <int n>
+    SIMD_vecf shift_down() const {
+        static_assert(n >= 0 && n < 4, "shifts are 0 to 3 lanes");
+        return SIMD_vecf(_mm_castsi128_ps(_mm_srli_si128(_mm_castps_si128(data), 4 * n)));
+    }
+
+    // Lane `lane` of this in every lane
+    template <int lane>
+    SIMD_vecf broadcast() const {
+        return permute<lane, lane, lane, lane>();
+    }
+
+    // Lane `lane` of this
+    template <int lane>
+    float extract() const {
+        static_assert(lane >= 0 && lane < 4, "lanes are 0 to 3");
+        return _mm_cvtss_f32(_mm_shuffle_ps(data, data, lane));
+    }
+
+    // Sets lane `lane` to value
+    template <int lane>
+    void insert(float value) {
+        static_assert(lane >= 0 && lane < 4, "lanes are 0 to 3");
+        data = _mm_insert_ps(data, _mm_set_ss(value), lane << 4);
+    }
+
+    // Sets lane index to value, for an index only known at run time
+    void insert(size_t index, float value) {
+        __m128i lane = _mm_cmpeq_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int>(index)));
+        data = _mm_blendv_ps(data, _mm_set1_ps(value), _mm_castsi128_ps(lane));
     }
 
     /* ----------------------------------------Misc.--------------------------------------------------*/
@@ -365,145 +777,145 @@ struct SIMD_vecf {
     // Returns sin(this)
     SIMD_vecf sin()
     {
-        return SIMD_vecf(_mm_sin_ps(data));
+        return SIMD_vecf(math::sin(data));
     }
     // this = sin(this)
     void inline_sin()
     {
-        data = _mm_sin_ps(data);
+        data = math::sin(data);
     }
 
     // Returns asin(this)
     SIMD_vecf asin()
     {
-        return SIMD_vecf(_mm_asin_ps(data));
+        return SIMD_vecf(math::asin(data));
     }
     // this = asin(this)
     void inline_asin()
     {
-        data = _mm_asin_ps(data);
+        data = math::asin(data);
     }
     // LAZY CHECKPOINT
 
     SIMD_vecf sinh()
     {
-        return SIMD_vecf(_mm_sinh_ps(data));
+        return SIMD_vecf(math::sinh(data));
     }
 
     void inline_sinh()
     {
-        data = _mm_sinh_ps(data);
+        data = math::sinh(data);
     }
 
 
     SIMD_vecf asinh()
     {
-        return SIMD_vecf(_mm_asinh_ps(data));
+        return SIMD_vecf(math::asinh(data));
     }
 
     void inline_asinh()
     {
-        data = _mm_asinh_ps(data);
+        data = math::asinh(data);
     }
 
     SIMD_vecf cos()
     {
-        return SIMD_vecf(_mm_cos_ps(data));
+        return SIMD_vecf(math::cos(data));
     }
 
     void inline_cos()
     {
-        data = _mm_cos_ps(data);
+        data = math::cos(data);
     }
 
     SIMD_vecf acos()
     {
-        return SIMD_vecf(_mm_acos_ps(data));
+        return SIMD_vecf(math::acos(data));
     }
 
     void inline_acos()
     {
-        data = _mm_acos_ps(data);
+        data = math::acos(data);
     }
 
     SIMD_vecf cosh()
     {
-        return SIMD_vecf(_mm_cosh_ps(data));
+        return SIMD_vecf(math::cosh(data));
     }
 
     void inline_cosh()
     {
-        data = _mm_cosh_ps(data);
+        data = math::cosh(data);
     }
 
     SIMD_vecf acosh()
     {
-        return SIMD_vecf(_mm_acosh_ps(data));
+        return SIMD_vecf(math::acosh(data));
     }
 
     void inline_acosh()
     {
-        data = _mm_acosh_ps(data);
+        data = math::acosh(data);
     }
 
     SIMD_vecf tan()
     {
-        return SIMD_vecf(_mm_tan_ps(data));
+        return SIMD_vecf(math::tan(data));
     }
 
     void inline_tan()
     {
-        data = _mm_tan_ps(data);
+        data = math::tan(data);
     }
 
     SIMD_vecf atan()
     {
-        return SIMD_vecf(_mm_atan_ps(data));
+        return SIMD_vecf(math::atan(data));
     }
     void inline_atan()
     {
-        data = _mm_atan_ps(data);
+        data = math::atan(data);
     }
 
     SIMD_vecf tanh()
     {
-        return SIMD_vecf(_mm_tanh_ps(data));
+        return SIMD_vecf(math::tanh(data));
     }
 
     void inline_tanh()
     {
-        data = _mm_tanh_ps(data);
+        data = math::tanh(data);
     }
     SIMD_vecf atanh()
     {
-        return SIMD_vecf(_mm_atanh_ps(data));
+        return SIMD_vecf(math::atanh(data));
     }
 
     void inline_atanh()
     {
-        data = _mm_atanh_ps(data);
+        data = math::atanh(data);
     }
 
     SIMD_vecf atan2(const SIMD_vecf& y)
     {
-        return SIMD_vecf(_mm_atan2_ps(data, y.data));
+        return SIMD_vecf(math::atan2(data, y.data));
     }
 
     void inline_atan2(const SIMD_vecf& y)
     {
-        data = _mm_atan2_ps(data, y.data);
+        data = math::atan2(data, y.data);
     }
 
     SIMD_vecf atan2(const float& y)
     {
         __m128 Y = _mm_set1_ps(y);
-        return SIMD_vecf(_mm_atan2_ps(data, Y));
+        return SIMD_vecf(math::atan2(data, Y));
     }
 
     void inline_atan2(const float& y)
     {
         __m128 Y = _mm_set1_ps(y);
-        data = _mm_atan2_ps(data, Y);
+        data = math::atan2(data, Y);
     }
 
 
@@ -538,86 +950,85 @@ struct SIMD_vecf {
     /* -------------------------SIMD conditionals------------------------ */
 
 
-    // TODO: Add alternatives that take in on_true and on_false options to select those, instead of 1.0 or 0.0
     // Overload the < operator for SIMD_vecf
-    SIMD_vecf operator<(const SIMD_vecf& other) const {
-        __m128 cmp_result = _mm_cmp_ps(data, other.data, _CMP_LT_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator<(const SIMD_vecf& other) const {
+        __m128 cmp_result = _mm_cmplt_ps(data, other.data);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the <= operator for SIMD_vecf
-    SIMD_vecf operator<=(const SIMD_vecf& other) const {
-        __m128 cmp_result = _mm_cmp_ps(data, other.data, _CMP_LE_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator<=(const SIMD_vecf& other) const {
+        __m128 cmp_result = _mm_cmple_ps(data, other.data);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the > operator for SIMD_vecf
-    SIMD_vecf operator>(const SIMD_vecf& other) const {
-        __m128 cmp_result = _mm_cmp_ps(data, other.data, _CMP_GT_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator>(const SIMD_vecf& other) const {
+        __m128 cmp_result = _mm_cmpgt_ps(data, other.data);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the >= operator for SIMD_vecf
-    SIMD_vecf operator>=(const SIMD_vecf& other) const {
-        __m128 cmp_result = _mm_cmp_ps(data, other.data, _CMP_GE_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator>=(const SIMD_vecf& other) const {
+        __m128 cmp_result = _mm_cmpge_ps(data, other.data);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the == operator for SIMD_vecf
-    SIMD_vecf operator==(const SIMD_vecf& other) const {
-        __m128 cmp_result = _mm_cmp_ps(data, other.data, _CMP_EQ_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator==(const SIMD_vecf& other) const {
+        __m128 cmp_result = _mm_cmpeq_ps(data, other.data);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the != operator for SIMD_vecf
-    SIMD_vecf operator!=(const SIMD_vecf& other) const {
-        __m128 cmp_result = _mm_cmp_ps(data, other.data, _CMP_NEQ_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator!=(const SIMD_vecf& other) const {
+        __m128 cmp_result = _mm_cmpneq_ps(data, other.data);
+        return SIMD_maskf(cmp_result);
     }
 
     /* -------------------------SISD conditionals------------------------ */
 
     // Overload the < operator for SIMD_vecf
-    SIMD_vecf operator<(const float& other) const {
+    SIMD_maskf operator<(const float& other) const {
         __m128 mask = _mm_set1_ps(other);
-        __m128 cmp_result = _mm_cmp_ps(data, mask, _CMP_LT_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+        __m128 cmp_result = _mm_cmplt_ps(data, mask);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the <= operator for SIMD_vecf
-    SIMD_vecf operator<=(const float& other) const {
+    SIMD_maskf operator<=(const float& other) const {
         __m128 mask = _mm_set1_ps(other);
-        __m128 cmp_result = _mm_cmp_ps(data, mask, _CMP_LE_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+        __m128 cmp_result = _mm_cmple_ps(data, mask);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the > operator for SIMD_vecf
-    SIMD_vecf operator>(const float& other) const {
+    SIMD_maskf operator>(const float& other) const {
         __m128 mask = _mm_set1_ps(other);
-        __m128 cmp_result = _mm_cmp_ps(data, mask, _CMP_GT_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+        __m128 cmp_result = _mm_cmpgt_ps(data, mask);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the >= operator for SIMD_vecf
-    SIMD_vecf operator>=(const float& other) const {
+    SIMD_maskf operator>=(const float& other) const {
         __m128 mask = _mm_set1_ps(other);
-        __m128 cmp_result = _mm_cmp_ps(data, mask, _CMP_GE_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+        __m128 cmp_result = _mm_cmpge_ps(data, mask);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the == operator for SIMD_vecf
-    SIMD_vecf operator==(const float& other) const {
+    SIMD_maskf operator==(const float& other) const {
         __m128 mask = _mm_set1_ps(other);
-        __m128 cmp_result = _mm_cmp_ps(data, mask, _CMP_EQ_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+        __m128 cmp_result = _mm_cmpeq_ps(data, mask);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the != operator for SIMD_vecf
-    SIMD_vecf operator!=(const float& other) const {
+    SIMD_maskf operator!=(const float& other) const {
         // Create the mask
         __m128 mask = _mm_set1_ps(other);
-        __m128 cmp_result = _mm_cmp_ps(data, mask, _CMP_NEQ_OS);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+        __m128 cmp_result = _mm_cmpneq_ps(data, mask);
+        return SIMD_maskf(cmp_result);
     }
 
     /* -------------------------Binary operations------------------------ */
@@ -645,25 +1056,25 @@ struct SIMD_vecf {
     // Overload the logical AND operator for SIMD_vecf
     SIMD_vecf operator&&(const SIMD_vecf& other) const {
         __m128 cmp_result = _mm_and_ps(
-            _mm_cmp_ps(data, _mm_setzero_ps(), _CMP_NEQ_OQ),
-            _mm_cmp_ps(other.data, _mm_setzero_ps(), _CMP_NEQ_OQ)
+            _mm_cmpneq_ps(data, _mm_setzero_ps()),
+            _mm_cmpneq_ps(other.data, _mm_setzero_ps())
         );
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+        return SIMD_vecf(_mm_and_ps(cmp_result, _mm_set1_ps(1.0f)));
     }
 
     // Overload the logical OR operator for SIMD_vecf
     SIMD_vecf operator||(const SIMD_vecf& other) const {
         __m128 cmp_result = _mm_or_ps(
-            _mm_cmp_ps(data, _mm_setzero_ps(), _CMP_NEQ_OQ),
-            _mm_cmp_ps(other.data, _mm_setzero_ps(), _CMP_NEQ_OQ)
+            _mm_cmpneq_ps(data, _mm_setzero_ps()),
+            _mm_cmpneq_ps(other.data, _mm_setzero_ps())
         );
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+        return SIMD_vecf(_mm_and_ps(cmp_result, _mm_set1_ps(1.0f)));
     }
 
     // Overload the logical NOT operator for SIMD_vecf
     SIMD_vecf operator!() const {
-        __m128 cmp_result = _mm_cmp_ps(data, _mm_setzero_ps(), _CMP_EQ_OQ);
-        return SIMD_vecf(_mm_blendv_ps(_mm_setzero_ps(), _mm_set1_ps(1.0f), cmp_result));
+        __m128 cmp_result = _mm_cmpeq_ps(data, _mm_setzero_ps());
+        return SIMD_vecf(_mm_and_ps(cmp_result, _mm_set1_ps(1.0f)));
     }
 
     // Get the square root
@@ -675,20 +1086,19 @@ struct SIMD_vecf {
         data = _mm_sqrt_ps(data);
     }
 
-    // Optimize this later. Just return data[index]
+    // Lane index, moved to lane 0 with a byte shuffle instead of a round trip through memory
     float operator[](size_t index) const {
-        alignas(32) float vals[8];
-        _mm_storeu_ps(vals, data);
-        return vals[index];
+        __m128i bytes = _mm_set1_epi32(0x03020100 + 0x04040404 * static_cast<int>(index));
+        return _mm_cvtss_f32(_mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(data), bytes)));
     }
 
-    // returns this * multiplier + addend
+    // returns this * multiplier + addend. SSE has no FMA, so this is a separate multiply and add
     SIMD_vecf mul_add(const SIMD_vecf multiplier, const SIMD_vecf addend) const {
-        return SIMD_vecf(_mm_fmadd_ps(data, multiplier.data, addend.data));
+        return SIMD_vecf(_mm_add_ps(_mm_mul_ps(data, multiplier.data), addend.data));
     }
     // this = this * multiplier + addend
     void inline_mul_add(const SIMD_vecf multiplier, const SIMD_vecf addend) {
-        data = _mm_fmadd_ps(data, multiplier.data, addend.data);
+        data = _mm_add_ps(_mm_mul_ps(data, multiplier.data), addend.data);
     }
 
     // Overload the << operator for outputting SIMD_vecf values
@@ -701,27 +1111,33 @@ struct SIMD_vecf {
 
     // 8 packed floats per __m128
     static int SIMD_vecf_size() {
-        return SIMD_VECTOR_SIZE;
+        return static_cast<int>(width);
     }
 
     // Destructor
     ~SIMD_vecf() = default;
 
+    // Calls body() from a function compiled for this backend's instruction set, with everything body calls inlined into it.
+    // This is how kernels written for any width run here even when the rest of the binary targets a narrower baseline
+    template <typename body_t>
+    static SIMD_FLATTEN void run_targeted(const body_t& body) {
+        body();
+    }
+
 
 private:
     // Private Constructor to initialize with __m128 data. Private for a consistent interface
     SIMD_vecf(__m128 initial_data) : data(initial_data) {}
 
-    static const __m128 constants[6];
 
 };
 
-// Initialize the constants
-const __m128 SIMD_vecf::constants[6] = {
-    _mm_set1_ps(1.4426950408889634f), // log2(e)
-    _mm_set1_ps(1.0f),                // 1.0
-    _mm_set1_ps(0.5f),                // 0.5
-    _mm_set1_ps(0.3333333333333333f), // 1/3
-    _mm_set1_ps(0.25f),               // 0.25
-    _mm_set1_ps(0.0f)                 // 0.0
-};
+// if_true in the lanes where mask is set, if_false in the rest
+inline SIMD_vecf select(const SIMD_maskf& mask, const SIMD_vecf& if_true, const SIMD_vecf& if_false) {
+    SIMD_vecf result;
+    result.data = _mm_blendv_ps(if_false.data, if_true.data, mask.data);
+    return result;
+}
+
+} // namespace SIMD_128
+SIMD_TARGET_END
@@ -3,12 +3,176 @@
 #include <array>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include "SIMD_target.h"
+#include "SIMD_accuracy.h"
+
+SIMD_TARGET_BEGIN_AVX2
+namespace SIMD_256 {
+
+/* -------------------------Math primitives------------------------ */
+// The operations SIMD_math.inl is written against, so the same transcendental code compiles for every backend
+namespace math {
+    typedef __m256 vfloat;
+    typedef __m256i vint;
+    typedef __m256 vmask; // all ones in true lanes
+
+    inline vfloat vset(float x) { return _mm256_set1_ps(x); }
+    inline vint vseti(int x) { return _mm256_set1_epi32(x); }
+
+    inline vfloat vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+    inline vfloat vsub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+    inline vfloat vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+    inline vfloat vdiv(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+    inline vfloat vfma(vfloat a, vfloat b, vfloat c) { return _mm256_fmadd_ps(a, b, c); }
+    // The rounding error of p = a * b, exactly
+    inline vfloat vprod_error(vfloat a, vfloat b, vfloat p) { return _mm256_fmsub_ps(a, b, p); }
+    inline vfloat vsqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+    // Estimates good to 12 bits
+    inline vfloat vrcp(vfloat a) { return _mm256_rcp_ps(a); }
+    inline vfloat vrsqrt(vfloat a) { return _mm256_rsqrt_ps(a); }
+    inline vfloat vmin(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+    inline vfloat vmax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+    inline vfloat vround(vfloat a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    inline vfloat vtrunc(vfloat a) { return _mm256_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+
+    inline vfloat vand_bits(vfloat a, vfloat b) { return _mm256_and_ps(a, b); }
+    inline vfloat vor_bits(vfloat a, vfloat b) { return _mm256_or_ps(a, b); }
+    inline vfloat vxor_bits(vfloat a, vfloat b) { return _mm256_xor_ps(a, b); }
+    inline vfloat vandnot_bits(vfloat a, vfloat b) { return _mm256_andnot_ps(a, b); } // ~a & b
+    inline vfloat vabs(vfloat a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    inline vfloat vneg(vfloat a) { return _mm256_xor_ps(_mm256_set1_ps(-0.0f), a); }
+
+    inline vmask vlt(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    inline vmask vgt(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    inline vmask vge(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    inline vmask veq(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    inline vmask vneq(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+    inline vmask vand_m(vmask a, vmask b) { return _mm256_and_ps(a, b); }
+    inline vmask vor_m(vmask a, vmask b) { return _mm256_or_ps(a, b); }
+    inline vmask vandnot_m(vmask a, vmask b) { return _mm256_andnot_ps(a, b); } // !a && b
+    inline vmask vnot_m(vmask a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+    // if_true where the mask is set, if_false elsewhere
+    inline vfloat vselect(vmask mask, vfloat if_true, vfloat if_false) { return _mm256_blendv_ps(if_false, if_true, mask); }
+
+    inline vint vcvt_round(vfloat a) { return _mm256_cvtps_epi32(a); }
+    inline vint vcvt_trunc(vfloat a) { return _mm256_cvttps_epi32(a); }
+    inline vfloat vcvt_float(vint a) { return _mm256_cvtepi32_ps(a); }
+    inline vfloat vas_float(vint a) { return _mm256_castsi256_ps(a); }
+    inline vint vas_int(vfloat a) { return _mm256_castps_si256(a); }
+
+    inline vint vaddi(vint a, vint b) { return _mm256_add_epi32(a, b); }
+    inline vint vsubi(vint a, vint b) { return _mm256_sub_epi32(a, b); }
+    inline vint vandi(vint a, vint b) { return _mm256_and_si256(a, b); }
+    inline vint vori(vint a, vint b) { return _mm256_or_si256(a, b); }
+    inline vint vxori(vint a, vint b) { return _mm256_xor_si256(a, b); }
+    template <int bits> inline vint vshli(vint a) { return _mm256_slli_epi32(a, bits); }
+    template <int bits> inline vint vsrli(vint a) { return _mm256_srli_epi32(a, bits); }
+    template <int bits> inline vint vsrai(vint a) { return _mm256_srai_epi32(a, bits); }
+    inline vmask veqi(vint a, vint b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+} // namespace math
+
+#include "SIMD_math.inl"
+
+
+
+/* The result of comparing SIMD_vecfs: one bool per lane, kept as the raw compare bits (all ones or all zeroes per lane) instead of the 1.0f / 0.0f floats
+comparisons used to return, so branchless code can select() on it directly. The float form is still there by converting: SIMD_vecf(x < y).
 
-#define SIMD_VECTOR_SIZE 8
+Usage:
+SIMD_maskf inside = (x > -5.0f) & (x < 5.0f);
+x = select(inside, x * x, x); // Squares the elements between -5 and 5
+if (inside.none()) { ... }
+*/
+struct SIMD_maskf {
+    __m256 data;
+
+    // Lanes per mask
+    static const size_t width = 8;
+
+    // Basic constructor, doesn't initialize the data
+    SIMD_maskf() {}
+
+    // Sets every lane to value
+    explicit SIMD_maskf(bool value) : data(_mm256_castsi256_ps(_mm256_set1_epi32(value ? -1 : 0))) {}
+
+    // Set in the first count (<= 8) lanes, clear in the rest
+    static SIMD_maskf first(size_t count) {
+        return SIMD_maskf(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(count)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7))));
+    }
+
+    // Lane-wise AND
+    SIMD_maskf operator&(const SIMD_maskf& other) const {
+        return SIMD_maskf(_mm256_and_ps(data, other.data));
+    }
+
+    // Lane-wise OR
+    SIMD_maskf operator|(const SIMD_maskf& other) const {
+        return SIMD_maskf(_mm256_or_ps(data, other.data));
+    }
+
+    // Lane-wise XOR
+    SIMD_maskf operator^(const SIMD_maskf& other) const {
+        return SIMD_maskf(_mm256_xor_ps(data, other.data));
+    }
+
+    // Lane-wise NOT
+    SIMD_maskf operator~() const {
+        return SIMD_maskf(_mm256_xor_ps(data, _mm256_castsi256_ps(_mm256_set1_epi32(-1))));
+    }
+
+    // this = this & other
+    SIMD_maskf& operator&=(const SIMD_maskf& other) {
+        data = _mm256_and_ps(data, other.data);
+        return *this;
+    }
+
+    // this = this | other
+    SIMD_maskf& operator|=(const SIMD_maskf& other) {
+        data = _mm256_or_ps(data, other.data);
+        return *this;
+    }
+
+    // One bit per lane, lane 0 in the lowest bit
+    int bits() const {
+        return _mm256_movemask_ps(data);
+    }
+
+    // True if any lane is set
+    bool any() const {
+        return bits() != 0;
+    }
+
+    // True if every lane is set
+    bool all() const {
+        return bits() == 0xFF;
+    }
+
+    // True if no lane is set
+    bool none() const {
+        return bits() == 0;
+    }
 
+    // Number of lanes set
+    int popcount() const {
+        unsigned int count = static_cast<unsigned int>(bits());
+        count = count - ((count >> 1) & 0x5555);
+        count = (count & 0x3333) + ((count >> 2) & 0x3333);
+        count = (count + (count >> 4)) & 0x0F0F;
+        return static_cast<int>((count + (count >> 8)) & 0x1F);
+    }
 
+    // Whether lane index is set
+    bool operator[](size_t index) const {
+        return ((bits() >> index) & 1) != 0;
+    }
 
+private:
+    // Private Constructor to initialize with raw compare results. Private for a consistent interface
+    explicit SIMD_maskf(__m256 compare_result) : data(compare_result) {}
 
+    friend struct SIMD_vecf;
+};
 
 
 /* Abstract SIMD float vector type. The size of the vector varies based on what the CPU you are compiling for can handle.
@@ -16,7 +180,7 @@ For machines with AVX-512 support, this will store a __m512 and call the appropr
 For machines with only AVX2, this will store a __m256. SSE2? __m128. No support? Defaults to float.
 
 Since this is meant to be an abstraction for use in parallelized systems, all operations are executed using the appropriate instruction for their vector size.
-For high-end machines, pow() executes _mm512_pow_ps on the underlying __m512, but on an old PC without SIMD support, pow() is just the standard C implementation, no SIMD tricks.
+For high-end machines, pow() runs the vectorized code in SIMD_math.inl on the underlying __m512, but on an old PC without SIMD support, pow() is just the standard C implementation, no SIMD tricks.
 
 send a function pointer to the driver, and have it run your task using SIMD (if available) on as many cores as the CPU can handle.
 
@@ -28,6 +192,7 @@ SIMD_vecf y = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f}; // specify each
 SIMD_vecf mask = (y < 5); // Compares each element of y to 5. 1.0f if true, 0.0f otherwise.
 y += 3.0; // Add 3.0 to each element of y
 std::cout << y; // print y
+float total = y.hsum(); // Adds up the lanes of y
 y.inline_pow(mask + 1.0f); // For any element < 5, it squares it, otherwise, it stays the same.
 
 On its own, this is pretty useless, however, the power becomes clear when you create peice-wise functions and pass a pointer to the function to the compute engine.
@@ -36,14 +201,23 @@ Performance tips:
 Try to use the inline variants of every function if at all possible. Instead of returning the expression, it just changes the calling instance's data instead of returning an altered copy.
 In a single call, this is nigh meaningless, but at scale, it's incredibly detrimental to the performance of your application.
 
+If a power is a whole number (or a half) known at compile time, use x.inline_pow<2>() or x.inline_pow<3, 2>() over x.inline_pow(2.0f). They
+compile to a few multiplies (and a sqrt), where pow() with an arbitrary exponent takes a log and an exp.
+
 Another suggested method is to partition your data in such a way so that it's as contiguous as possible. If you have two arrays, X, and Y, the last element of X should touch the first element of Y.
 This makes cache happy and reduces the amount of reads / writes to disk we perform, which is often the largest bottleneck in computing - memory bandwidth
 
-You should also stay away from branching. If you need conditional computation, use the select() method. It takes in the output if(true), and the output if(false), as well as a mask
+You should also stay away from branching. If you need conditional computation, use select(mask, if_true, if_false) with the SIMD_maskf a comparison returns
 */
 struct SIMD_vecf {
     __m256 data;
 
+    // Floats per vector
+    static const size_t width = 8;
+
+    // What the comparison operators return
+    typedef SIMD_maskf mask_type;
+
 
     /* --------------------------------CONSTRUCTORS------------------------------------*/
     
@@ -53,6 +227,9 @@ struct SIMD_vecf {
     // Initialize a SIMD_vecf from a float. Copies initial_data in every slot
     SIMD_vecf(float initial_data) : data(_mm256_set1_ps(initial_data)) {}
 
+    // 1.0f in the lanes where mask is set and 0.0f in the rest, the form comparisons returned before SIMD_maskf
+    SIMD_vecf(const SIMD_maskf& mask) : data(_mm256_and_ps(mask.data, _mm256_set1_ps(1.0f))) {}
+
 
     // Constructor to initialize with std::initializer_list
     SIMD_vecf(std::initializer_list<float> init_list) {
@@ -74,13 +251,31 @@ struct SIMD_vecf {
 
     // Gets a vector of ones
     SIMD_vecf ones() const {
-        return SIMD_vecf(constants[1]);
+        return SIMD_vecf(_mm256_set1_ps(1.0f));
 
     }
 
     // Gets a vector of zeroes
     SIMD_vecf zeroes() const {
-        return SIMD_vecf(constants[5]);
+        return SIMD_vecf(_mm256_setzero_ps());
+    }
+
+    /* ---------------------------Partial loads and stores---------------------------- */
+
+    // Loads the first count (< 8) floats from source and zeroes the remaining lanes. Never reads past source[count - 1]
+    static SIMD_vecf load_partial(const float* source, size_t count) {
+        return SIMD_vecf(_mm256_maskload_ps(source, lane_mask(count)));
+    }
+
+    // Stores the first count (< 8) lanes to destination. Never writes past destination[count - 1]
+    void store_partial(float* destination, size_t count) const {
+        _mm256_maskstore_ps(destination, lane_mask(count), data);
+    }
+
+    // Stores to destination, which must be aligned to a whole vector, with a non-temporal store that bypasses the caches. The store is
+    // weakly ordered: other threads are only guaranteed to see it after this thread runs _mm_sfence()
+    void store_stream(float* destination) const {
+        _mm256_stream_ps(destination, data);
     }
 
     /* -----------------------Arithmetic w/SIMD_vecf-------------------------- */
@@ -106,7 +301,7 @@ struct SIMD_vecf {
     }
 
     SIMD_vecf operator%(const SIMD_vecf& other) const {
-        return SIMD_vecf(_mm256_fmod_ps(data, other.data));
+        return SIMD_vecf(math::fmod(data, other.data));
     }
 
     /* -------------------- Arithmetic with standard 32-bit float -------------------- */
@@ -138,7 +333,7 @@ struct SIMD_vecf {
 
     SIMD_vecf operator%(const float& other) const {
         __m256 vector = _mm256_set1_ps(other);
-        return SIMD_vecf(_mm256_fmod_ps(data, vector));
+        return SIMD_vecf(math::fmod(data, vector));
     }
 
     SIMD_vecf operator-() const {
@@ -173,7 +368,7 @@ struct SIMD_vecf {
     }
 
     SIMD_vecf& operator%=(const SIMD_vecf& other) {
-        data = _mm256_fmod_ps(data, other.data);
+        data = math::fmod(data, other.data);
         return *this;
 
     }
@@ -215,7 +410,7 @@ struct SIMD_vecf {
 
     SIMD_vecf& operator%=(const float& other) {
         __m256 vector = _mm256_set1_ps(other);
-        data = _mm256_fmod_ps(data, vector);
+        data = math::fmod(data, vector);
         return *this;
     }
 
@@ -223,86 +418,273 @@ struct SIMD_vecf {
 
     // Returns this ^ Y
     SIMD_vecf pow(const SIMD_vecf& Y) {
-        return SIMD_vecf(_mm256_pow_ps(data, Y.data));
+        return SIMD_vecf(math::pow(data, Y.data));
     }
 
     // this = this ^ Y
     void inline_pow(const SIMD_vecf& Y) {
-        data = _mm256_pow_ps(data, Y.data);
+        data = math::pow(data, Y.data);
     }
 
-    //  Constructs a vector where every element is y and returns this ^ y.
+    // Returns this ^ y. Whole y from -4 to 4 is multiplied out instead of going through log and exp
     SIMD_vecf pow(const float y) {
-        __m256 Y = _mm256_set1_ps(y);
-        return SIMD_vecf(_mm256_pow_ps(data, Y));
+        return SIMD_vecf(math::pow(data, y));
     }
 
-    // Constructs a vector where every element is y and sets this = this ^ y.
+    // Sets this = this ^ y. Whole y from -4 to 4 is multiplied out instead of going through log and exp
     void inline_pow(const float y) {
-        __m256 Y = _mm256_set1_ps(y);
-        data = _mm256_pow_ps(data, Y);
+        data = math::pow(data, y);
+    }
+
+    // Returns this ^ (N / D), D = 1 or 2, as a chain of multiplies built at compile time. pow<3>() is x * x * x,
+    // pow<-2>() is 1 / (x * x) and pow<3, 2>() is x * sqrt(x)
+    template <int N, int D = 1>
+    SIMD_vecf pow() const {
+        return SIMD_vecf(math::pow<N, D>(data));
+    }
+
+    // this = this ^ (N / D), D = 1 or 2, as a chain of multiplies built at compile time
+    template <int N, int D = 1>
+    void inline_pow() {
+        data = math::pow<N, D>(data);
     }
 
     // Computes the natural log of each element
     SIMD_vecf log() const {
-        return SIMD_vecf(_mm256_log_ps(data));
+        return SIMD_vecf(math::log(data));
     }
     // this = log (this)
     void inline_log() {
-        data = _mm256_log_ps(data);
+        data = math::log(data);
     }
 
     // Returns log2(this)
     SIMD_vecf log2() const {
-        return SIMD_vecf(_mm256_log2_ps(data));
+        return SIMD_vecf(math::log2(data));
     }
     // this = log2(this)
     void inline_log2() {
-        data = _mm256_log2_ps(data);
+        data = math::log2(data);
     }
 
     // Returns log10(this)
     SIMD_vecf log10() const {
-        return SIMD_vecf(_mm256_log2_ps(data));
+        return SIMD_vecf(math::log10(data));
     }
     // This = log10(this)
     void inline_log10() {
-        data = _mm256_log2_ps(data);
+        data = math::log10(data);
     }
     
     // Returns exp(this)
     SIMD_vecf exp()
     {
-        return SIMD_vecf(_mm256_exp_ps(data));
+        return SIMD_vecf(math::exp(data));
     }
     // this = exp(this)
     void inline_exp()
     {
-        data =  _mm256_exp_ps(data);
+        data =  math::exp(data);
     }
 
     // Returns exp2(this)
     SIMD_vecf exp2()
     {
-        return SIMD_vecf(_mm256_exp2_ps(data));
+        return SIMD_vecf(math::exp2(data));
     }
 
     // this = exp2(this)
     void inline_exp2()
     {
-        data = _mm256_exp2_ps(data);
+        data = math::exp2(data);
     }
 
     // Returns exp10(this)
     SIMD_vecf exp10()
     {
-        return SIMD_vecf(_mm256_exp10_ps(data));
+        return SIMD_vecf(math::exp10(data));
     }
 
     // this = exp10(this)
     void inline_exp10()
     {
-        data = _mm256_exp10_ps(data);
+        data = math::exp10(data);
+    }
+
+    /* ---------------------------------Accuracy tiers---------------------------------------*/
+    // Each takes SIMD_fast, SIMD_standard or SIMD_precise as its last argument. See SIMD_accuracy.h
+
+    // Returns this ^ Y at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf pow(const SIMD_vecf& Y, accuracy_t tier) const {
+        return SIMD_vecf(math::pow(data, Y.data, tier));
+    }
+    // this = this ^ Y at the given accuracy
+    template <typename accuracy_t>
+    void inline_pow(const SIMD_vecf& Y, accuracy_t tier) {
+        data = math::pow(data, Y.data, tier);
+    }
+
+    // Returns e ^ this at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf exp(accuracy_t tier) const {
+        return SIMD_vecf(math::exp(data, tier));
+    }
+    // this = e ^ this at the given accuracy
+    template <typename accuracy_t>
+    void inline_exp(accuracy_t tier) {
+        data = math::exp(data, tier);
+    }
+
+    // Returns log(this) at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf log(accuracy_t tier) const {
+        return SIMD_vecf(math::log(data, tier));
+    }
+    // this = log(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_log(accuracy_t tier) {
+        data = math::log(data, tier);
+    }
+
+    // Returns sin(this) at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf sin(accuracy_t tier) const {
+        return SIMD_vecf(math::sin(data, tier));
+    }
+    // this = sin(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_sin(accuracy_t tier) {
+        data = math::sin(data, tier);
+    }
+
+    // Returns the square root at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf sqrt(accuracy_t tier) const {
+        return SIMD_vecf(math::sqrt(data, tier));
+    }
+    // this = sqrt(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_sqrt(accuracy_t tier) {
+        data = math::sqrt(data, tier);
+    }
+
+    // Returns 1 / this
+    SIMD_vecf rcp() const {
+        return rcp(SIMD_precise);
+    }
+    // this = 1 / this
+    void inline_rcp() {
+        inline_rcp(SIMD_precise);
+    }
+    // Returns 1 / this at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf rcp(accuracy_t tier) const {
+        return SIMD_vecf(math::rcp(data, tier));
+    }
+    // this = 1 / this at the given accuracy
+    template <typename accuracy_t>
+    void inline_rcp(accuracy_t tier) {
+        data = math::rcp(data, tier);
+    }
+
+    // Returns 1 / sqrt(this)
+    SIMD_vecf rsqrt() const {
+        return rsqrt(SIMD_precise);
+    }
+    // this = 1 / sqrt(this)
+    void inline_rsqrt() {
+        inline_rsqrt(SIMD_precise);
+    }
+    // Returns 1 / sqrt(this) at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf rsqrt(accuracy_t tier) const {
+        return SIMD_vecf(math::rsqrt(data, tier));
+    }
+    // this = 1 / sqrt(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_rsqrt(accuracy_t tier) {
+        data = math::rsqrt(data, tier);
+    }
+
+    /* -----------------------------------------Cross-lane------------------------------------------*/
+    // Lanes are numbered from the low end of the register, the order the initializer list constructor fills them in
+
+    // Sum of every lane
+    float hsum() const {
+        __m128 halves = _mm_add_ps(_mm256_castps256_ps128(data), _mm256_extractf128_ps(data, 1));
+        __m128 pairs = _mm_add_ps(halves, _mm_movehl_ps(halves, halves));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehdup_ps(pairs)));
+    }
+
+    // Smallest lane. Unspecified if any lane is NaN
+    float hmin() const {
+        __m128 halves = _mm_min_ps(_mm256_castps256_ps128(data), _mm256_extractf128_ps(data, 1));
+        __m128 pairs = _mm_min_ps(halves, _mm_movehl_ps(halves, halves));
+        return _mm_cvtss_f32(_mm_min_ss(pairs, _mm_movehdup_ps(pairs)));
+    }
+
+    // Largest lane. Unspecified if any lane is NaN
+    float hmax() const {
+        __m128 halves = _mm_max_ps(_mm256_castps256_ps128(data), _mm256_extractf128_ps(data, 1));
+        __m128 pairs = _mm_max_ps(halves, _mm_movehl_ps(halves, halves));
+        return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_movehdup_ps(pairs)));
+    }
+
+    // Lane i of the result is lane i<n> of this, across the 128-bit halves. permute<7, 6, 5, 4, 3, 2, 1, 0>() reverses the lanes
+    template <int i0, int i1, int i2, int i3, int i4, int i5, int i6, int i7>
+    SIMD_vecf permute() const {
+        static_assert((i0 | i1 | i2 | i3 | i4 | i5 | i6 | i7) >= 0 && (i0 | i1 | i2 | i3 | i4 | i5 | i6 | i7) < 8, "lanes are 0 to 7");
+        return SIMD_vecf(_mm256_permutevar8x32_ps(data, _mm256_setr_epi32(i0, i1, i2, i3, i4, i5, i6, i7)));
+    }
+
+    // Lane i of the result is lane (i + n) mod 8 of this. rotate<1>() moves every lane down one, lane 0 to the top
+    template <int n>
+    SIMD_vecf rotate() const {
+        const int r = (n % 8 + 8) % 8;
+        return permute<r, (r + 1) % 8, (r + 2) % 8, (r + 3) % 8, (r + 4) % 8, (r + 5) % 8, (r + 6) % 8, (r + 7) % 8>();
+    }
+
+    // Lane i of the result is lane i - n of this, or 0.0f for i < n
+    template <int n>
+    SIMD_vecf shift_up() const {
+        static_assert(n >= 0 && n < 8, "shifts are 0 to 7 lanes");
+        return SIMD_vecf(_mm256_blend_ps(_mm256_setzero_ps(), rotate<-n>().data, (0xFF << n) & 0xFF));
+    }
+
+    // Lane i of the result is lane i + n of this, or 0.0f for i >= 8 - n
+    template <int n>
+    SIMD_vecf shift_down() const {
+        static_assert(n >= 0 && n < 8, "shifts are 0 to 7 lanes");
+        return SIMD_vecf(_mm256_blend_ps(_mm256_setzero_ps(), rotate<n>().data, 0xFF >> n));
+    }
+
+    // Lane `lane` of this in every lane
+    template <int lane>
+    SIMD_vecf broadcast() const {
+        static_assert(lane >= 0 && lane < 8, "lanes are 0 to 7");
+        return SIMD_vecf(_mm256_permutevar8x32_ps(data, _mm256_set1_epi32(lane)));
+    }
+
+    // Lane `lane` of this
+    template <int lane>
+    float extract() const {
+        static_assert(lane >= 0 && lane < 8, "lanes are 0 to 7");
+        __m128 half = lane < 4 ? _mm256_castps256_ps128(data) : _mm256_extractf128_ps(data, 1);
+        return _mm_cvtss_f32(_mm_shuffle_ps(half, half, lane % 4));
+    }
+
+    // Sets lane `lane` to value
+    template <int lane>
+    void insert(float value) {
+        static_assert(lane >= 0 && lane < 8, "lanes are 0 to 7");
+        data = _mm256_blend_ps(data, _mm256_set1_ps(value), 1 << lane);
+    }
+
+    // Sets lane index to value, for an index only known at run time
+    void insert(size_t index, float value) {
+        __m256i lane = _mm256_cmpeq_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(index)));
+        data = _mm256_blendv_ps(data, _mm256_set1_ps(value), _mm256_castsi256_ps(lane));
     }
 
     /* ----------------------------------------Misc.--------------------------------------------------*/
@@ -366,145 +748,145 @@ struct SIMD_vecf {
     // Returns sin(this)
     SIMD_vecf sin()
     {
-        return SIMD_vecf (_mm256_sin_ps(data));
+        return SIMD_vecf (math::sin(data));
     }
     // this = sin(this)
     void inline_sin()
     {
-        data = _mm256_sin_ps(data);
+        data = math::sin(data);
     }
 
     // Returns asin(this)
     SIMD_vecf asin()
     {
-        return SIMD_vecf(_mm256_asin_ps(data));
+        return SIMD_vecf(math::asin(data));
     }
     // this = asin(this)
     void inline_asin()
     {
-        data = _mm256_asin_ps(data);
+        data = math::asin(data);
     }
     // LAZY CHECKPOINT
 
     SIMD_vecf sinh()
     {
-        return SIMD_vecf(_mm256_sinh_ps(data));
+        return SIMD_vecf(math::sinh(data));
     }
     
     void inline_sinh()
     {
-        data = _mm256_sinh_ps(data);
+        data = math::sinh(data);
     }
 
 
     SIMD_vecf asinh()
     {
-        return SIMD_vecf(_mm256_asinh_ps(data));
+        return SIMD_vecf(math::asinh(data));
     }
 
     void inline_asinh()
     {
-        data = _mm256_asinh_ps(data);
+        data = math::asinh(data);
     }
 
     SIMD_vecf cos()
     {
-        return SIMD_vecf(_mm256_cos_ps(data));
+        return SIMD_vecf(math::cos(data));
     }
 
     void inline_cos()
     {
-        data = _mm256_cos_ps(data);
+        data = math::cos(data);
     }
 
     SIMD_vecf acos()
     {
-        return SIMD_vecf(_mm256_acos_ps(data));
+        return SIMD_vecf(math::acos(data));
     }
 
     void inline_acos()
     {
-        data = _mm256_acos_ps(data);
+        data = math::acos(data);
     }
 
     SIMD_vecf cosh()
     {
-        return SIMD_vecf(_mm256_cosh_ps(data));
+        return SIMD_vecf(math::cosh(data));
     }
 
     void inline_cosh()
     {
-        data = _mm256_cosh_ps(data);
+        data = math::cosh(data);
     }
 
     SIMD_vecf acosh()
     {
-        return SIMD_vecf(_mm256_acosh_ps(data));
+        return SIMD_vecf(math::acosh(data));
     }
 
     void inline_acosh()
     {
-        data = _mm256_acosh_ps(data);
+        data = math::acosh(data);
     }
 
     SIMD_vecf tan()
     {
-        return SIMD_vecf(_mm256_tan_ps(data));
+        return SIMD_vecf(math::tan(data));
     }
 
     void inline_tan()
     {
-        data = _mm256_tan_ps(data);
+        data = math::tan(data);
     }
     
     SIMD_vecf atan()
     {
-        return SIMD_vecf(_mm256_atan_ps(data));
+        return SIMD_vecf(math::atan(data));
     }
     void inline_atan()
     {
-        data = _mm256_atan_ps(data);
+        data = math::atan(data);
     }
 
     SIMD_vecf tanh()
     {
-        return SIMD_vecf(_mm256_tanh_ps(data));
+        return SIMD_vecf(math::tanh(data));
     }
 
     void inline_tanh()
     {
-        data = _mm256_tanh_ps(data);
+        data = math::tanh(data);
     }
     SIMD_vecf atanh()
     {
-        return SIMD_vecf(_mm256_atanh_ps(data));
+        return SIMD_vecf(math::atanh(data));
     }
 
     void inline_atanh()
     {
-        data = _mm256_atanh_ps(data);
+        data = math::atanh(data);
     }
 
     SIMD_vecf atan2(const SIMD_vecf& y)
     {
-        return SIMD_vecf(_mm256_atan2_ps(data, y.data));
+        return SIMD_vecf(math::atan2(data, y.data));
     }
 
     void inline_atan2(const SIMD_vecf& y)
     {
-        data = _mm256_atan2_ps(data, y.data);
+        data = math::atan2(data, y.data);
     }
 
     SIMD_vecf atan2(const float& y)
     {
         __m256 Y = _mm256_set1_ps(y);
-        return SIMD_vecf(_mm256_atan2_ps(data, Y));
+        return SIMD_vecf(math::atan2(data, Y));
     }
 
     void inline_atan2(const float& y)
     {
         __m256 Y = _mm256_set1_ps(y);
-        data = _mm256_atan2_ps(data, Y);
+        data = math::atan2(data, Y);
     }
 
 
@@ -539,86 +921,85 @@ struct SIMD_vecf {
     /* -------------------------SIMD conditionals------------------------ */
 
 
-    // TODO: Add alternatives that take in on_true and on_false options to select those, instead of 1.0 or 0.0
     // Overload the < operator for SIMD_vecf
-    SIMD_vecf operator<(const SIMD_vecf& other) const {
+    SIMD_maskf operator<(const SIMD_vecf& other) const {
         __m256 cmp_result = _mm256_cmp_ps(data, other.data, _CMP_LT_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the <= operator for SIMD_vecf
-    SIMD_vecf operator<=(const SIMD_vecf& other) const {
+    SIMD_maskf operator<=(const SIMD_vecf& other) const {
         __m256 cmp_result = _mm256_cmp_ps(data, other.data, _CMP_LE_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the > operator for SIMD_vecf
-    SIMD_vecf operator>(const SIMD_vecf& other) const {
+    SIMD_maskf operator>(const SIMD_vecf& other) const {
         __m256 cmp_result = _mm256_cmp_ps(data, other.data, _CMP_GT_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the >= operator for SIMD_vecf
-    SIMD_vecf operator>=(const SIMD_vecf& other) const {
+    SIMD_maskf operator>=(const SIMD_vecf& other) const {
         __m256 cmp_result = _mm256_cmp_ps(data, other.data, _CMP_GE_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the == operator for SIMD_vecf
-    SIMD_vecf operator==(const SIMD_vecf& other) const {
+    SIMD_maskf operator==(const SIMD_vecf& other) const {
         __m256 cmp_result = _mm256_cmp_ps(data, other.data, _CMP_EQ_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the != operator for SIMD_vecf
-    SIMD_vecf operator!=(const SIMD_vecf& other) const {
+    SIMD_maskf operator!=(const SIMD_vecf& other) const {
         __m256 cmp_result = _mm256_cmp_ps(data, other.data, _CMP_NEQ_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     /* -------------------------SISD conditionals------------------------ */
 
     // Overload the < operator for SIMD_vecf
-    SIMD_vecf operator<(const float& other) const {
+    SIMD_maskf operator<(const float& other) const {
         __m256 mask = _mm256_set1_ps(other);
         __m256 cmp_result = _mm256_cmp_ps(data, mask, _CMP_LT_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the <= operator for SIMD_vecf
-    SIMD_vecf operator<=(const float& other) const {
+    SIMD_maskf operator<=(const float& other) const {
         __m256 mask = _mm256_set1_ps(other);
         __m256 cmp_result = _mm256_cmp_ps(data, mask, _CMP_LE_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the > operator for SIMD_vecf
-    SIMD_vecf operator>(const float& other) const {
+    SIMD_maskf operator>(const float& other) const {
         __m256 mask = _mm256_set1_ps(other);
         __m256 cmp_result = _mm256_cmp_ps(data, mask, _CMP_GT_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the >= operator for SIMD_vecf
-    SIMD_vecf operator>=(const float& other) const {
+    SIMD_maskf operator>=(const float& other) const {
         __m256 mask = _mm256_set1_ps(other);
         __m256 cmp_result = _mm256_cmp_ps(data, mask, _CMP_GE_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the == operator for SIMD_vecf
-    SIMD_vecf operator==(const float& other) const {
+    SIMD_maskf operator==(const float& other) const {
         __m256 mask = _mm256_set1_ps(other);
         __m256 cmp_result = _mm256_cmp_ps(data, mask, _CMP_EQ_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the != operator for SIMD_vecf
-    SIMD_vecf operator!=(const float& other) const {
+    SIMD_maskf operator!=(const float& other) const {
         // Create the mask
         __m256 mask = _mm256_set1_ps(other);
         __m256 cmp_result = _mm256_cmp_ps(data, mask, _CMP_NEQ_OS);
-        return SIMD_vecf(_mm256_blendv_ps(_mm256_setzero_ps(), _mm256_set1_ps(1.0f), cmp_result));
+        return SIMD_maskf(cmp_result);
     }
 
     /* -------------------------Binary operations------------------------ */
@@ -676,11 +1057,10 @@ struct SIMD_vecf {
         data = _mm256_sqrt_ps(data);
     }
 
-    // Optimize this later. Just return data[index]
+    // Lane index, moved to lane 0 with a variable permute instead of a round trip through memory
     float operator[](size_t index) const {
-        alignas(32) float vals[8];
-        _mm256_storeu_ps(vals, data);
-        return vals[index];
+        __m256 moved = _mm256_permutevar8x32_ps(data, _mm256_set1_epi32(static_cast<int>(index)));
+        return _mm_cvtss_f32(_mm256_castps256_ps128(moved));
     }
 
     // returns this * multiplier + addend
@@ -702,27 +1082,39 @@ struct SIMD_vecf {
 
     // 8 packed floats per __m256
     static int SIMD_vecf_size() {
-        return SIMD_VECTOR_SIZE;
+        return static_cast<int>(width);
     }
 
     // Destructor
     ~SIMD_vecf() = default;
 
+    // Calls body() from a function compiled for this backend's instruction set, with everything body calls inlined into it.
+    // This is how kernels written for any width run here even when the rest of the binary targets a narrower baseline
+    template <typename body_t>
+    static SIMD_FLATTEN void run_targeted(const body_t& body) {
+        body();
+    }
+
 
 private:
     // Private Constructor to initialize with __m256 data. Private for a consistent interface
     SIMD_vecf(__m256 initial_data) : data(initial_data) {}
 
-    static const __m256 constants[6];
 
-};
+    // All ones in the first count lanes, zero in the rest. Read as a sliding window so it works on AVX without AVX2 compares
+    static __m256i lane_mask(size_t count) {
+        static const int mask_table[16] = { -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0 };
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask_table + 8 - count));
+    }
 
-// Initialize the constants
-const __m256 SIMD_vecf::constants[6] = {
-    _mm256_set1_ps(1.4426950408889634f), // log2(e)
-    _mm256_set1_ps(1.0f),                // 1.0
-    _mm256_set1_ps(0.5f),                // 0.5
-    _mm256_set1_ps(0.3333333333333333f), // 1/3
-    _mm256_set1_ps(0.25f),               // 0.25
-    _mm256_set1_ps(0.0f)                 // 0.0
 };
+
+// if_true in the lanes where mask is set, if_false in the rest
+inline SIMD_vecf select(const SIMD_maskf& mask, const SIMD_vecf& if_true, const SIMD_vecf& if_false) {
+    SIMD_vecf result;
+    result.data = _mm256_blendv_ps(if_false.data, if_true.data, mask.data);
+    return result;
+}
+
+} // namespace SIMD_256
+SIMD_TARGET_END
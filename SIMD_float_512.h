@@ -3,12 +3,177 @@
 #include <array>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include "SIMD_target.h"
+#include "SIMD_accuracy.h"
+
+SIMD_TARGET_BEGIN_AVX512
+namespace SIMD_512 {
+
+/* -------------------------Math primitives------------------------ */
+// The operations SIMD_math.inl is written against, so the same transcendental code compiles for every backend
+namespace math {
+    typedef __m512 vfloat;
+    typedef __m512i vint;
+    typedef __mmask16 vmask; // one bit per lane
+
+    inline vfloat vset(float x) { return _mm512_set1_ps(x); }
+    inline vint vseti(int x) { return _mm512_set1_epi32(x); }
+
+    inline vfloat vadd(vfloat a, vfloat b) { return _mm512_add_ps(a, b); }
+    inline vfloat vsub(vfloat a, vfloat b) { return _mm512_sub_ps(a, b); }
+    inline vfloat vmul(vfloat a, vfloat b) { return _mm512_mul_ps(a, b); }
+    inline vfloat vdiv(vfloat a, vfloat b) { return _mm512_div_ps(a, b); }
+    inline vfloat vfma(vfloat a, vfloat b, vfloat c) { return _mm512_fmadd_ps(a, b, c); }
+    // The rounding error of p = a * b, exactly
+    inline vfloat vprod_error(vfloat a, vfloat b, vfloat p) { return _mm512_fmsub_ps(a, b, p); }
+    inline vfloat vsqrt(vfloat a) { return _mm512_sqrt_ps(a); }
+    // Estimates good to 14 bits
+    inline vfloat vrcp(vfloat a) { return _mm512_rcp14_ps(a); }
+    inline vfloat vrsqrt(vfloat a) { return _mm512_rsqrt14_ps(a); }
+    inline vfloat vmin(vfloat a, vfloat b) { return _mm512_min_ps(a, b); }
+    inline vfloat vmax(vfloat a, vfloat b) { return _mm512_max_ps(a, b); }
+    inline vfloat vround(vfloat a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    inline vfloat vtrunc(vfloat a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+
+    // Float bitwise ops need AVX-512DQ, so these go through the integer unit
+    inline vfloat vand_bits(vfloat a, vfloat b) { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+    inline vfloat vor_bits(vfloat a, vfloat b) { return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+    inline vfloat vxor_bits(vfloat a, vfloat b) { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+    inline vfloat vandnot_bits(vfloat a, vfloat b) { return _mm512_castsi512_ps(_mm512_andnot_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); } // ~a & b
+    inline vfloat vabs(vfloat a) { return _mm512_abs_ps(a); }
+    inline vfloat vneg(vfloat a) { return vxor_bits(_mm512_set1_ps(-0.0f), a); }
+
+    inline vmask vlt(vfloat a, vfloat b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    inline vmask vgt(vfloat a, vfloat b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    inline vmask vge(vfloat a, vfloat b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+    inline vmask veq(vfloat a, vfloat b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+    inline vmask vneq(vfloat a, vfloat b) { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ); }
+    inline vmask vand_m(vmask a, vmask b) { return _mm512_kand(a, b); }
+    inline vmask vor_m(vmask a, vmask b) { return _mm512_kor(a, b); }
+    inline vmask vandnot_m(vmask a, vmask b) { return _mm512_kandn(a, b); } // !a && b
+    inline vmask vnot_m(vmask a) { return _mm512_knot(a); }
+    // if_true where the mask is set, if_false elsewhere
+    inline vfloat vselect(vmask mask, vfloat if_true, vfloat if_false) { return _mm512_mask_blend_ps(mask, if_false, if_true); }
+
+    inline vint vcvt_round(vfloat a) { return _mm512_cvtps_epi32(a); }
+    inline vint vcvt_trunc(vfloat a) { return _mm512_cvttps_epi32(a); }
+    inline vfloat vcvt_float(vint a) { return _mm512_cvtepi32_ps(a); }
+    inline vfloat vas_float(vint a) { return _mm512_castsi512_ps(a); }
+    inline vint vas_int(vfloat a) { return _mm512_castps_si512(a); }
+
+    inline vint vaddi(vint a, vint b) { return _mm512_add_epi32(a, b); }
+    inline vint vsubi(vint a, vint b) { return _mm512_sub_epi32(a, b); }
+    inline vint vandi(vint a, vint b) { return _mm512_and_si512(a, b); }
+    inline vint vori(vint a, vint b) { return _mm512_or_si512(a, b); }
+    inline vint vxori(vint a, vint b) { return _mm512_xor_si512(a, b); }
+    template <int bits> inline vint vshli(vint a) { return _mm512_slli_epi32(a, bits); }
+    template <int bits> inline vint vsrli(vint a) { return _mm512_srli_epi32(a, bits); }
+    template <int bits> inline vint vsrai(vint a) { return _mm512_srai_epi32(a, bits); }
+    inline vmask veqi(vint a, vint b) { return _mm512_cmpeq_epi32_mask(a, b); }
+} // namespace math
+
+#include "SIMD_math.inl"
+
+
+
+/* The result of comparing SIMD_vecfs: one bool per lane, kept as the raw compare bits (one bit per lane in an AVX-512 mask register) instead of the 1.0f / 0.0f floats
+comparisons used to return, so branchless code can select() on it directly. The float form is still there by converting: SIMD_vecf(x < y).
 
-#define SIMD_VECTOR_SIZE 16
+Usage:
+SIMD_maskf inside = (x > -5.0f) & (x < 5.0f);
+x = select(inside, x * x, x); // Squares the elements between -5 and 5
+if (inside.none()) { ... }
+*/
+struct SIMD_maskf {
+    __mmask16 data;
+
+    // Lanes per mask
+    static const size_t width = 16;
+
+    // Basic constructor, doesn't initialize the data
+    SIMD_maskf() {}
+
+    // Sets every lane to value
+    explicit SIMD_maskf(bool value) : data(static_cast<__mmask16>(value ? 0xFFFF : 0)) {}
+
+    // Set in the first count (<= 16) lanes, clear in the rest
+    static SIMD_maskf first(size_t count) {
+        return SIMD_maskf(static_cast<__mmask16>((1u << count) - 1));
+    }
 
+    // Lane-wise AND
+    SIMD_maskf operator&(const SIMD_maskf& other) const {
+        return SIMD_maskf(_mm512_kand(data, other.data));
+    }
 
+    // Lane-wise OR
+    SIMD_maskf operator|(const SIMD_maskf& other) const {
+        return SIMD_maskf(_mm512_kor(data, other.data));
+    }
 
+    // Lane-wise XOR
+    SIMD_maskf operator^(const SIMD_maskf& other) const {
+        return SIMD_maskf(_mm512_kxor(data, other.data));
+    }
 
+    // Lane-wise NOT
+    SIMD_maskf operator~() const {
+        return SIMD_maskf(_mm512_knot(data));
+    }
+
+    // this = this & other
+    SIMD_maskf& operator&=(const SIMD_maskf& other) {
+        data = _mm512_kand(data, other.data);
+        return *this;
+    }
+
+    // this = this | other
+    SIMD_maskf& operator|=(const SIMD_maskf& other) {
+        data = _mm512_kor(data, other.data);
+        return *this;
+    }
+
+    // One bit per lane, lane 0 in the lowest bit
+    int bits() const {
+        return static_cast<int>(data);
+    }
+
+    // True if any lane is set
+    bool any() const {
+        return bits() != 0;
+    }
+
+    // True if every lane is set
+    bool all() const {
+        return bits() == 0xFFFF;
+    }
+
+    // True if no lane is set
+    bool none() const {
+        return bits() == 0;
+    }
+
+    // Number of lanes set
+    int popcount() const {
+        unsigned int count = static_cast<unsigned int>(bits());
+        count = count - ((count >> 1) & 0x5555);
+        count = (count & 0x3333) + ((count >> 2) & 0x3333);
+        count = (count + (count >> 4)) & 0x0F0F;
+        return static_cast<int>((count + (count >> 8)) & 0x1F);
+    }
+
+    // Whether lane index is set
+    bool operator[](size_t index) const {
+        return ((bits() >> index) & 1) != 0;
+    }
+
+private:
+    // Private Constructor to initialize with raw compare results. Private for a consistent interface
+    explicit SIMD_maskf(__mmask16 compare_result) : data(compare_result) {}
+
+    friend struct SIMD_vecf;
+};
 
 
 /* Abstract SIMD float vector type. The size of the vector varies based on what the CPU you are compiling for can handle.
@@ -16,7 +181,7 @@ For machines with AVX-512 support, this will store a __m512 and call the appropr
 For machines with only AVX2, this will store a __m512. SSE2? __m128. No support? Defaults to float.
 
 Since this is meant to be an abstraction for use in parallelized systems, all operations are executed using the appropriate instruction for their vector size.
-For high-end machines, pow() executes _mm512_pow_ps on the underlying __m512, but on an old PC without SIMD support, pow() is just the standard C implementation, no SIMD tricks.
+For high-end machines, pow() runs the vectorized code in SIMD_math.inl on the underlying __m512, but on an old PC without SIMD support, pow() is just the standard C implementation, no SIMD tricks.
 
 send a function pointer to the driver, and have it run your task using SIMD (if available) on as many cores as the CPU can handle.
 
@@ -28,6 +193,7 @@ SIMD_vecf y = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f}; // specify each
 SIMD_vecf mask = (y < 5); // Compares each element of y to 5. 1.0f if true, 0.0f otherwise.
 y += 3.0; // Add 3.0 to each element of y
 std::cout << y; // print y
+float total = y.hsum(); // Adds up the lanes of y
 y.inline_pow(mask + 1.0f); // For any element < 5, it squares it, otherwise, it stays the same.
 
 On its own, this is pretty useless, however, the power becomes clear when you create peice-wise functions and pass a pointer to the function to the compute engine.
@@ -36,14 +202,23 @@ Performance tips:
 Try to use the inline variants of every function if at all possible. Instead of returning the expression, it just changes the calling instance's data instead of returning an altered copy.
 In a single call, this is nigh meaningless, but at scale, it's incredibly detrimental to the performance of your application.
 
+If a power is a whole number (or a half) known at compile time, use x.inline_pow<2>() or x.inline_pow<3, 2>() over x.inline_pow(2.0f). They
+compile to a few multiplies (and a sqrt), where pow() with an arbitrary exponent takes a log and an exp.
+
 Another suggested method is to partition your data in such a way so that it's as contiguous as possible. If you have two arrays, X, and Y, the last element of X should touch the first element of Y.
 This makes cache happy and reduces the amount of reads / writes to disk we perform, which is often the largest bottleneck in computing - memory bandwidth
 
-You should also stay away from branching. If you need conditional computation, use the select() method. It takes in the output if(true), and the output if(false), as well as a mask
+You should also stay away from branching. If you need conditional computation, use select(mask, if_true, if_false) with the SIMD_maskf a comparison returns
 */
 struct SIMD_vecf {
     __m512 data;
 
+    // Floats per vector
+    static const size_t width = 16;
+
+    // What the comparison operators return
+    typedef SIMD_maskf mask_type;
+
 
     /* --------------------------------CONSTRUCTORS------------------------------------*/
 
@@ -53,20 +228,23 @@ struct SIMD_vecf {
     // Initialize a SIMD_vecf from a float. Copies initial_data in every slot
     SIMD_vecf(float initial_data) : data(_mm512_set1_ps(initial_data)) {}
 
+    // 1.0f in the lanes where mask is set and 0.0f in the rest, the form comparisons returned before SIMD_maskf
+    SIMD_vecf(const SIMD_maskf& mask) : data(_mm512_maskz_mov_ps(mask.data, _mm512_set1_ps(1.0f))) {}
+
 
     // Constructor to initialize with std::initializer_list
     SIMD_vecf(std::initializer_list<float> init_list) {
-        float temp[8] = { 0.0f }; // Initialize to zeroes
+        float temp[16] = { 0.0f }; // Initialize to zeroes
         std::copy(init_list.begin(), init_list.end(), temp);
         data = _mm512_loadu_ps(temp);
     }
 
     // Constructor to initialize with std::array
-    SIMD_vecf(const std::array<float, 8>& arr) {
+    SIMD_vecf(const std::array<float, 16>& arr) {
         data = _mm512_loadu_ps(arr.data());
     }
 
-    // Constructor to initialize with an array of 8 floats
+    // Constructor to initialize with an array of 16 floats
     SIMD_vecf(const float* initial_data) {
         data = _mm512_loadu_ps(initial_data);
     }
@@ -74,13 +252,31 @@ struct SIMD_vecf {
 
     // Gets a vector of ones
     SIMD_vecf ones() const {
-        return SIMD_vecf(constants[1]);
+        return SIMD_vecf(_mm512_set1_ps(1.0f));
 
     }
 
     // Gets a vector of zeroes
     SIMD_vecf zeroes() const {
-        return SIMD_vecf(constants[5]);
+        return SIMD_vecf(_mm512_setzero_ps());
+    }
+
+    /* ---------------------------Partial loads and stores---------------------------- */
+
+    // Loads the first count (< 16) floats from source and zeroes the remaining lanes. Never reads past source[count - 1]
+    static SIMD_vecf load_partial(const float* source, size_t count) {
+        return SIMD_vecf(_mm512_maskz_loadu_ps(lane_mask(count), source));
+    }
+
+    // Stores the first count (< 16) lanes to destination. Never writes past destination[count - 1]
+    void store_partial(float* destination, size_t count) const {
+        _mm512_mask_storeu_ps(destination, lane_mask(count), data);
+    }
+
+    // Stores to destination, which must be aligned to a whole vector, with a non-temporal store that bypasses the caches. The store is
+    // weakly ordered: other threads are only guaranteed to see it after this thread runs _mm_sfence()
+    void store_stream(float* destination) const {
+        _mm512_stream_ps(destination, data);
     }
 
     /* -----------------------Arithmetic w/SIMD_vecf-------------------------- */
@@ -106,7 +302,7 @@ struct SIMD_vecf {
     }
 
     SIMD_vecf operator%(const SIMD_vecf& other) const {
-        return SIMD_vecf(_mm512_fmod_ps(data, other.data));
+        return SIMD_vecf(math::fmod(data, other.data));
     }
 
     /* -------------------- Arithmetic with standard 32-bit float -------------------- */
@@ -138,7 +334,7 @@ struct SIMD_vecf {
 
     SIMD_vecf operator%(const float& other) const {
         __m512 vector = _mm512_set1_ps(other);
-        return SIMD_vecf(_mm512_fmod_ps(data, vector));
+        return SIMD_vecf(math::fmod(data, vector));
     }
 
     SIMD_vecf operator-() const {
@@ -173,7 +369,7 @@ struct SIMD_vecf {
     }
 
     SIMD_vecf& operator%=(const SIMD_vecf& other) {
-        data = _mm512_fmod_ps(data, other.data);
+        data = math::fmod(data, other.data);
         return *this;
 
     }
@@ -215,7 +411,7 @@ struct SIMD_vecf {
 
     SIMD_vecf& operator%=(const float& other) {
         __m512 vector = _mm512_set1_ps(other);
-        data = _mm512_fmod_ps(data, vector);
+        data = math::fmod(data, vector);
         return *this;
     }
 
@@ -223,140 +419,320 @@ struct SIMD_vecf {
 
     // Returns this ^ Y
     SIMD_vecf pow(const SIMD_vecf& Y) {
-        return SIMD_vecf(_mm512_pow_ps(data, Y.data));
+        return SIMD_vecf(math::pow(data, Y.data));
     }
 
     // this = this ^ Y
     void inline_pow(const SIMD_vecf& Y) {
-        data = _mm512_pow_ps(data, Y.data);
+        data = math::pow(data, Y.data);
     }
 
-    //  Constructs a vector where every element is y and returns this ^ y.
+    // Returns this ^ y. Whole y from -4 to 4 is multiplied out instead of going through log and exp
     SIMD_vecf pow(const float y) {
-        __m512 Y = _mm512_set1_ps(y);
-        return SIMD_vecf(_mm512_pow_ps(data, Y));
+        return SIMD_vecf(math::pow(data, y));
     }
 
-    // Constructs a vector where every element is y and sets this = this ^ y.
+    // Sets this = this ^ y. Whole y from -4 to 4 is multiplied out instead of going through log and exp
     void inline_pow(const float y) {
-        __m512 Y = _mm512_set1_ps(y);
-        data = _mm512_pow_ps(data, Y);
+        data = math::pow(data, y);
+    }
+
+    // Returns this ^ (N / D), D = 1 or 2, as a chain of multiplies built at compile time. pow<3>() is x * x * x,
+    // pow<-2>() is 1 / (x * x) and pow<3, 2>() is x * sqrt(x)
+    template <int N, int D = 1>
+    SIMD_vecf pow() const {
+        return SIMD_vecf(math::pow<N, D>(data));
+    }
+
+    // this = this ^ (N / D), D = 1 or 2, as a chain of multiplies built at compile time
+    template <int N, int D = 1>
+    void inline_pow() {
+        data = math::pow<N, D>(data);
     }
 
     // Computes the natural log of each element
     SIMD_vecf log() const {
-        return SIMD_vecf(_mm512_log_ps(data));
+        return SIMD_vecf(math::log(data));
     }
     // this = log (this)
     void inline_log() {
-        data = _mm512_log_ps(data);
+        data = math::log(data);
     }
 
     // Returns log2(this)
     SIMD_vecf log2() const {
-        return SIMD_vecf(_mm512_log2_ps(data));
+        return SIMD_vecf(math::log2(data));
     }
     // this = log2(this)
     void inline_log2() {
-        data = _mm512_log2_ps(data);
+        data = math::log2(data);
     }
 
     // Returns log10(this)
     SIMD_vecf log10() const {
-        return SIMD_vecf(_mm512_log2_ps(data));
+        return SIMD_vecf(math::log10(data));
     }
     // This = log10(this)
     void inline_log10() {
-        data = _mm512_log2_ps(data);
+        data = math::log10(data);
     }
 
     // Returns exp(this)
     SIMD_vecf exp()
     {
-        return SIMD_vecf(_mm512_exp_ps(data));
+        return SIMD_vecf(math::exp(data));
     }
     // this = exp(this)
     void inline_exp()
     {
-        data = _mm512_exp_ps(data);
+        data = math::exp(data);
     }
 
     // Returns exp2(this)
     SIMD_vecf exp2()
     {
-        return SIMD_vecf(_mm512_exp2_ps(data));
+        return SIMD_vecf(math::exp2(data));
     }
 
     // this = exp2(this)
     void inline_exp2()
     {
-        data = _mm512_exp2_ps(data);
+        data = math::exp2(data);
     }
 
     // Returns exp10(this)
     SIMD_vecf exp10()
     {
-        return SIMD_vecf(_mm512_exp10_ps(data));
+        return SIMD_vecf(math::exp10(data));
     }
 
     // this = exp10(this)
     void inline_exp10()
     {
-        data = _mm512_exp10_ps(data);
+        data = math::exp10(data);
+    }
+
+    /* ---------------------------------Accuracy tiers---------------------------------------*/
+    // Each takes SIMD_fast, SIMD_standard or SIMD_precise as its last argument. See SIMD_accuracy.h
+
+    // Returns this ^ Y at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf pow(const SIMD_vecf& Y, accuracy_t tier) const {
+        return SIMD_vecf(math::pow(data, Y.data, tier));
+    }
+    // this = this ^ Y at the given accuracy
+    template <typename accuracy_t>
+    void inline_pow(const SIMD_vecf& Y, accuracy_t tier) {
+        data = math::pow(data, Y.data, tier);
+    }
+
+    // Returns e ^ this at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf exp(accuracy_t tier) const {
+        return SIMD_vecf(math::exp(data, tier));
+    }
+    // this = e ^ this at the given accuracy
+    template <typename accuracy_t>
+    void inline_exp(accuracy_t tier) {
+        data = math::exp(data, tier);
+    }
+
+    // Returns log(this) at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf log(accuracy_t tier) const {
+        return SIMD_vecf(math::log(data, tier));
+    }
+    // this = log(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_log(accuracy_t tier) {
+        data = math::log(data, tier);
+    }
+
+    // Returns sin(this) at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf sin(accuracy_t tier) const {
+        return SIMD_vecf(math::sin(data, tier));
+    }
+    // this = sin(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_sin(accuracy_t tier) {
+        data = math::sin(data, tier);
+    }
+
+    // Returns the square root at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf sqrt(accuracy_t tier) const {
+        return SIMD_vecf(math::sqrt(data, tier));
+    }
+    // this = sqrt(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_sqrt(accuracy_t tier) {
+        data = math::sqrt(data, tier);
+    }
+
+    // Returns 1 / this
+    SIMD_vecf rcp() const {
+        return rcp(SIMD_precise);
+    }
+    // this = 1 / this
+    void inline_rcp() {
+        inline_rcp(SIMD_precise);
+    }
+    // Returns 1 / this at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf rcp(accuracy_t tier) const {
+        return SIMD_vecf(math::rcp(data, tier));
+    }
+    // this = 1 / this at the given accuracy
+    template <typename accuracy_t>
+    void inline_rcp(accuracy_t tier) {
+        data = math::rcp(data, tier);
+    }
+
+    // Returns 1 / sqrt(this)
+    SIMD_vecf rsqrt() const {
+        return rsqrt(SIMD_precise);
+    }
+    // this = 1 / sqrt(this)
+    void inline_rsqrt() {
+        inline_rsqrt(SIMD_precise);
+    }
+    // Returns 1 / sqrt(this) at the given accuracy
+    template <typename accuracy_t>
+    SIMD_vecf rsqrt(accuracy_t tier) const {
+        return SIMD_vecf(math::rsqrt(data, tier));
+    }
+    // this = 1 / sqrt(this) at the given accuracy
+    template <typename accuracy_t>
+    void inline_rsqrt(accuracy_t tier) {
+        data = math::rsqrt(data, tier);
+    }
+
+    /* -----------------------------------------Cross-lane------------------------------------------*/
+    // Lanes are numbered from the low end of the register, the order the initializer list constructor fills them in
+
+    // Sum of every lane
+    float hsum() const {
+        return _mm512_reduce_add_ps(data);
+    }
+
+    // Smallest lane. Unspecified if any lane is NaN
+    float hmin() const {
+        return _mm512_reduce_min_ps(data);
+    }
+
+    // Largest lane. Unspecified if any lane is NaN
+    float hmax() const {
+        return _mm512_reduce_max_ps(data);
+    }
+
+    // Lane i of the result is lane i<n> of this, across the whole register. permute<15, 14, ..., 0>() reverses the lanes
+    template <int i0, int i1, int i2, int i3, int i4, int i5, int i6, int i7, int i8, int i9, int i10, int i11, int i12, int i13, int i14, int i15>
+    SIMD_vecf permute() const {
+        static_assert((i0 | i1 | i2 | i3 | i4 | i5 | i6 | i7 | i8 | i9 | i10 | i11 | i12 | i13 | i14 | i15) >= 0 &&
+            (i0 | i1 | i2 | i3 | i4 | i5 | i6 | i7 | i8 | i9 | i10 | i11 | i12 | i13 | i14 | i15) < 16, "lanes are 0 to 15");
+        return SIMD_vecf(_mm512_permutexvar_ps(_mm512_setr_epi32(i0, i1, i2, i3, i4, i5, i6, i7, i8, i9, i10, i11, i12, i13, i14, i15), data));
+    }
+
+    // Lane i of the result is lane (i + n) mod 16 of this. rotate<1>() moves every lane down one, lane 0 to the top
+    template <int n>
+    SIMD_vecf rotate() const {
+        __m512i lanes = _mm512_castps_si512(data);
+        return SIMD_vecf(_mm512_castsi512_ps(_mm512_alignr_epi32(lanes, lanes, (n % 16 + 16) % 16)));
+    }
+
+    // Lane i of the result is lane i - n of this, or 0.0f for i < n
+    template <int n>
+    SIMD_vecf shift_up() const {
+        static_assert(n >= 0 && n < 16, "shifts are 0 to 15 lanes");
+        __m512i lanes = _mm512_castps_si512(data);
+        return n == 0 ? *this : SIMD_vecf(_mm512_castsi512_ps(_mm512_alignr_epi32(lanes, _mm512_setzero_si512(), (16 - n) % 16)));
+    }
+
+    // Lane i of the result is lane i + n of this, or 0.0f for i >= 16 - n
+    template <int n>
+    SIMD_vecf shift_down() const {
+        static_assert(n >= 0 && n < 16, "shifts are 0 to 15 lanes");
+        return SIMD_vecf(_mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_setzero_si512(), _mm512_castps_si512(data), n)));
+    }
+
+    // Lane `lane` of this in every lane
+    template <int lane>
+    SIMD_vecf broadcast() const {
+        static_assert(lane >= 0 && lane < 16, "lanes are 0 to 15");
+        return SIMD_vecf(_mm512_permutexvar_ps(_mm512_set1_epi32(lane), data));
+    }
+
+    // Lane `lane` of this
+    template <int lane>
+    float extract() const {
+        static_assert(lane >= 0 && lane < 16, "lanes are 0 to 15");
+        __m128 quarter = _mm512_extractf32x4_ps(data, lane / 4);
+        return _mm_cvtss_f32(_mm_shuffle_ps(quarter, quarter, lane % 4));
+    }
+
+    // Sets lane `lane` to value
+    template <int lane>
+    void insert(float value) {
+        static_assert(lane >= 0 && lane < 16, "lanes are 0 to 15");
+        data = _mm512_mask_broadcastss_ps(data, static_cast<__mmask16>(1u << lane), _mm_set_ss(value));
+    }
+
+    // Sets lane index to value, for an index only known at run time
+    void insert(size_t index, float value) {
+        data = _mm512_mask_mov_ps(data, static_cast<__mmask16>(1u << index), _mm512_set1_ps(value));
     }
 
     /* ----------------------------------------Misc.--------------------------------------------------*/
 
     // Returns ceil (this)
     SIMD_vecf ceil() {
-        return _mm512_round_ps(data, _MM_FROUND_TO_POS_INF);
+        return _mm512_roundscale_ps(data, _MM_FROUND_TO_POS_INF);
     }
 
     // this = ceil (this)
     void inline_ceil() {
-        data = _mm512_round_ps(data, _MM_FROUND_TO_POS_INF);
+        data = _mm512_roundscale_ps(data, _MM_FROUND_TO_POS_INF);
     }
 
     // Returns floor (this)
     SIMD_vecf floor() {
-        return _mm512_round_ps(data, _MM_FROUND_TO_NEG_INF);
+        return _mm512_roundscale_ps(data, _MM_FROUND_TO_NEG_INF);
     }
 
     // this = floor (this)
     void inline_floor() {
-        data = _mm512_round_ps(data, _MM_FROUND_TO_NEG_INF);
+        data = _mm512_roundscale_ps(data, _MM_FROUND_TO_NEG_INF);
     }
 
     // Returns round(this)
     SIMD_vecf round() {
-        return _mm512_round_ps(data, _MM_FROUND_TO_NEAREST_INT);
+        return _mm512_roundscale_ps(data, _MM_FROUND_TO_NEAREST_INT);
     }
 
     // this = round(this)
     void inline_round() {
-        data = _mm512_round_ps(data, _MM_FROUND_TO_NEAREST_INT);
+        data = _mm512_roundscale_ps(data, _MM_FROUND_TO_NEAREST_INT);
     }
 
     // returns this rounded towards zero
     SIMD_vecf truncate() {
-        return _mm512_round_ps(data, _MM_FROUND_TO_ZERO);
+        return _mm512_roundscale_ps(data, _MM_FROUND_TO_ZERO);
     }
 
     // Rounds this towards zero
     void inline_truncate() {
-        data = _mm512_round_ps(data, _MM_FROUND_TO_ZERO);
+        data = _mm512_roundscale_ps(data, _MM_FROUND_TO_ZERO);
     }
 
     // returns abs(this)
     SIMD_vecf abs() {
-        const __m512 mask = _mm512_castsi256_ps(_mm512_set1_epi32(0x7FFFFFFF));
-        return _mm512_and_ps(data, mask);
+        return _mm512_abs_ps(data);
     }
 
     // this = abs(this)
     void inline_abs() {
-        const __m512 mask = _mm512_castsi256_ps(_mm512_set1_epi32(0x7FFFFFFF));
-        data = _mm512_and_ps(data, mask);
+        data = _mm512_abs_ps(data);
     }
 
     /* ------------------------------------------------Trig functions------------------------------------------------- */
@@ -366,145 +742,145 @@ struct SIMD_vecf {
     // Returns sin(this)
     SIMD_vecf sin()
     {
-        return SIMD_vecf(_mm512_sin_ps(data));
+        return SIMD_vecf(math::sin(data));
     }
     // this = sin(this)
     void inline_sin()
     {
-        data = _mm512_sin_ps(data);
+        data = math::sin(data);
     }
 
     // Returns asin(this)
     SIMD_vecf asin()
     {
-        return SIMD_vecf(_mm512_asin_ps(data));
+        return SIMD_vecf(math::asin(data));
     }
     // this = asin(this)
     void inline_asin()
     {
-        data = _mm512_asin_ps(data);
+        data = math::asin(data);
     }
     // LAZY CHECKPOINT
 
     SIMD_vecf sinh()
     {
-        return SIMD_vecf(_mm512_sinh_ps(data));
+        return SIMD_vecf(math::sinh(data));
     }
 
     void inline_sinh()
     {
-        data = _mm512_sinh_ps(data);
+        data = math::sinh(data);
     }
 
 
     SIMD_vecf asinh()
     {
-        return SIMD_vecf(_mm512_asinh_ps(data));
+        return SIMD_vecf(math::asinh(data));
     }
 
     void inline_asinh()
     {
-        data = _mm512_asinh_ps(data);
+        data = math::asinh(data);
     }
 
     SIMD_vecf cos()
     {
-        return SIMD_vecf(_mm512_cos_ps(data));
+        return SIMD_vecf(math::cos(data));
     }
 
     void inline_cos()
     {
-        data = _mm512_cos_ps(data);
+        data = math::cos(data);
     }
 
     SIMD_vecf acos()
     {
-        return SIMD_vecf(_mm512_acos_ps(data));
+        return SIMD_vecf(math::acos(data));
     }
 
     void inline_acos()
     {
-        data = _mm512_acos_ps(data);
+        data = math::acos(data);
     }
 
     SIMD_vecf cosh()
     {
-        return SIMD_vecf(_mm512_cosh_ps(data));
+        return SIMD_vecf(math::cosh(data));
     }
 
     void inline_cosh()
     {
-        data = _mm512_cosh_ps(data);
+        data = math::cosh(data);
     }
 
     SIMD_vecf acosh()
     {
-        return SIMD_vecf(_mm512_acosh_ps(data));
+        return SIMD_vecf(math::acosh(data));
     }
 
     void inline_acosh()
     {
-        data = _mm512_acosh_ps(data);
+        data = math::acosh(data);
     }
 
     SIMD_vecf tan()
     {
-        return SIMD_vecf(_mm512_tan_ps(data));
+        return SIMD_vecf(math::tan(data));
     }
 
     void inline_tan()
     {
-        data = _mm512_tan_ps(data);
+        data = math::tan(data);
     }
 
     SIMD_vecf atan()
     {
-        return SIMD_vecf(_mm512_atan_ps(data));
+        return SIMD_vecf(math::atan(data));
     }
     void inline_atan()
     {
-        data = _mm512_atan_ps(data);
+        data = math::atan(data);
     }
 
     SIMD_vecf tanh()
     {
-        return SIMD_vecf(_mm512_tanh_ps(data));
+        return SIMD_vecf(math::tanh(data));
     }
 
     void inline_tanh()
     {
-        data = _mm512_tanh_ps(data);
+        data = math::tanh(data);
     }
     SIMD_vecf atanh()
     {
-        return SIMD_vecf(_mm512_atanh_ps(data));
+        return SIMD_vecf(math::atanh(data));
     }
 
     void inline_atanh()
     {
-        data = _mm512_atanh_ps(data);
+        data = math::atanh(data);
     }
 
     SIMD_vecf atan2(const SIMD_vecf& y)
     {
-        return SIMD_vecf(_mm512_atan2_ps(data, y.data));
+        return SIMD_vecf(math::atan2(data, y.data));
     }
 
     void inline_atan2(const SIMD_vecf& y)
     {
-        data = _mm512_atan2_ps(data, y.data);
+        data = math::atan2(data, y.data);
     }
 
     SIMD_vecf atan2(const float& y)
     {
         __m512 Y = _mm512_set1_ps(y);
-        return SIMD_vecf(_mm512_atan2_ps(data, Y));
+        return SIMD_vecf(math::atan2(data, Y));
     }
 
     void inline_atan2(const float& y)
     {
         __m512 Y = _mm512_set1_ps(y);
-        data = _mm512_atan2_ps(data, Y);
+        data = math::atan2(data, Y);
     }
 
 
@@ -539,132 +915,130 @@ struct SIMD_vecf {
     /* -------------------------SIMD conditionals------------------------ */
 
 
-    // TODO: Add alternatives that take in on_true and on_false options to select those, instead of 1.0 or 0.0
     // Overload the < operator for SIMD_vecf
-    SIMD_vecf operator<(const SIMD_vecf& other) const {
-        __m512 cmp_result = _mm512_cmp_ps(data, other.data, _CMP_LT_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator<(const SIMD_vecf& other) const {
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, other.data, _CMP_LT_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the <= operator for SIMD_vecf
-    SIMD_vecf operator<=(const SIMD_vecf& other) const {
-        __m512 cmp_result = _mm512_cmp_ps(data, other.data, _CMP_LE_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator<=(const SIMD_vecf& other) const {
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, other.data, _CMP_LE_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the > operator for SIMD_vecf
-    SIMD_vecf operator>(const SIMD_vecf& other) const {
-        __m512 cmp_result = _mm512_cmp_ps(data, other.data, _CMP_GT_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator>(const SIMD_vecf& other) const {
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, other.data, _CMP_GT_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the >= operator for SIMD_vecf
-    SIMD_vecf operator>=(const SIMD_vecf& other) const {
-        __m512 cmp_result = _mm512_cmp_ps(data, other.data, _CMP_GE_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator>=(const SIMD_vecf& other) const {
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, other.data, _CMP_GE_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the == operator for SIMD_vecf
-    SIMD_vecf operator==(const SIMD_vecf& other) const {
-        __m512 cmp_result = _mm512_cmp_ps(data, other.data, _CMP_EQ_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator==(const SIMD_vecf& other) const {
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, other.data, _CMP_EQ_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the != operator for SIMD_vecf
-    SIMD_vecf operator!=(const SIMD_vecf& other) const {
-        __m512 cmp_result = _mm512_cmp_ps(data, other.data, _CMP_NEQ_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+    SIMD_maskf operator!=(const SIMD_vecf& other) const {
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, other.data, _CMP_NEQ_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     /* -------------------------SISD conditionals------------------------ */
 
     // Overload the < operator for SIMD_vecf
-    SIMD_vecf operator<(const float& other) const {
+    SIMD_maskf operator<(const float& other) const {
         __m512 mask = _mm512_set1_ps(other);
-        __m512 cmp_result = _mm512_cmp_ps(data, mask, _CMP_LT_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, mask, _CMP_LT_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the <= operator for SIMD_vecf
-    SIMD_vecf operator<=(const float& other) const {
+    SIMD_maskf operator<=(const float& other) const {
         __m512 mask = _mm512_set1_ps(other);
-        __m512 cmp_result = _mm512_cmp_ps(data, mask, _CMP_LE_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, mask, _CMP_LE_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the > operator for SIMD_vecf
-    SIMD_vecf operator>(const float& other) const {
+    SIMD_maskf operator>(const float& other) const {
         __m512 mask = _mm512_set1_ps(other);
-        __m512 cmp_result = _mm512_cmp_ps(data, mask, _CMP_GT_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, mask, _CMP_GT_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the >= operator for SIMD_vecf
-    SIMD_vecf operator>=(const float& other) const {
+    SIMD_maskf operator>=(const float& other) const {
         __m512 mask = _mm512_set1_ps(other);
-        __m512 cmp_result = _mm512_cmp_ps(data, mask, _CMP_GE_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, mask, _CMP_GE_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the == operator for SIMD_vecf
-    SIMD_vecf operator==(const float& other) const {
+    SIMD_maskf operator==(const float& other) const {
         __m512 mask = _mm512_set1_ps(other);
-        __m512 cmp_result = _mm512_cmp_ps(data, mask, _CMP_EQ_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, mask, _CMP_EQ_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     // Overload the != operator for SIMD_vecf
-    SIMD_vecf operator!=(const float& other) const {
+    SIMD_maskf operator!=(const float& other) const {
         // Create the mask
         __m512 mask = _mm512_set1_ps(other);
-        __m512 cmp_result = _mm512_cmp_ps(data, mask, _CMP_NEQ_OS);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, mask, _CMP_NEQ_OS);
+        return SIMD_maskf(cmp_result);
     }
 
     /* -------------------------Binary operations------------------------ */
     // Overload the bitwise AND operator for SIMD_vecf
     SIMD_vecf operator&(const SIMD_vecf& other) const {
-        return SIMD_vecf(_mm512_and_ps(data, other.data));
+        return SIMD_vecf(_mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(data), _mm512_castps_si512(other.data))));
     }
 
     // Overload the bitwise OR operator for SIMD_vecf
     SIMD_vecf operator|(const SIMD_vecf& other) const {
-        return SIMD_vecf(_mm512_or_ps(data, other.data));
+        return SIMD_vecf(_mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(data), _mm512_castps_si512(other.data))));
     }
 
     // Overload the bitwise XOR operator for SIMD_vecf
     SIMD_vecf operator^(const SIMD_vecf& other) const {
-        return SIMD_vecf(_mm512_xor_ps(data, other.data));
+        return SIMD_vecf(_mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(data), _mm512_castps_si512(other.data))));
     }
 
     // Overload the bitwise NOT operator for SIMD_vecf
     SIMD_vecf operator~() const {
-        __m512 all_ones = _mm512_castsi256_ps(_mm512_set1_epi32(-1));
-        return SIMD_vecf(_mm512_xor_ps(data, all_ones));
+        return SIMD_vecf(_mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(data), _mm512_set1_epi32(-1))));
     }
 
     // Overload the logical AND operator for SIMD_vecf
     SIMD_vecf operator&&(const SIMD_vecf& other) const {
-        __m512 cmp_result = _mm512_and_ps(
-            _mm512_cmp_ps(data, _mm512_setzero_ps(), _CMP_NEQ_OQ),
-            _mm512_cmp_ps(other.data, _mm512_setzero_ps(), _CMP_NEQ_OQ)
+        __mmask16 cmp_result = _mm512_kand(
+            _mm512_cmp_ps_mask(data, _mm512_setzero_ps(), _CMP_NEQ_OQ),
+            _mm512_cmp_ps_mask(other.data, _mm512_setzero_ps(), _CMP_NEQ_OQ)
         );
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+        return SIMD_vecf(_mm512_maskz_mov_ps(cmp_result, _mm512_set1_ps(1.0f)));
     }
 
     // Overload the logical OR operator for SIMD_vecf
     SIMD_vecf operator||(const SIMD_vecf& other) const {
-        __m512 cmp_result = _mm512_or_ps(
-            _mm512_cmp_ps(data, _mm512_setzero_ps(), _CMP_NEQ_OQ),
-            _mm512_cmp_ps(other.data, _mm512_setzero_ps(), _CMP_NEQ_OQ)
+        __mmask16 cmp_result = _mm512_kor(
+            _mm512_cmp_ps_mask(data, _mm512_setzero_ps(), _CMP_NEQ_OQ),
+            _mm512_cmp_ps_mask(other.data, _mm512_setzero_ps(), _CMP_NEQ_OQ)
         );
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+        return SIMD_vecf(_mm512_maskz_mov_ps(cmp_result, _mm512_set1_ps(1.0f)));
     }
 
     // Overload the logical NOT operator for SIMD_vecf
     SIMD_vecf operator!() const {
-        __m512 cmp_result = _mm512_cmp_ps(data, _mm512_setzero_ps(), _CMP_EQ_OQ);
-        return SIMD_vecf(_mm512_blendv_ps(_mm512_setzero_ps(), _mm512_set1_ps(1.0f), cmp_result));
+        __mmask16 cmp_result = _mm512_cmp_ps_mask(data, _mm512_setzero_ps(), _CMP_EQ_OQ);
+        return SIMD_vecf(_mm512_maskz_mov_ps(cmp_result, _mm512_set1_ps(1.0f)));
     }
 
     // Get the square root
@@ -676,11 +1050,10 @@ struct SIMD_vecf {
         data = _mm512_sqrt_ps(data);
     }
 
-    // Optimize this later. Just return data[index]
+    // Lane index, moved to lane 0 with a variable permute instead of a round trip through memory
     float operator[](size_t index) const {
-        alignas(32) float vals[8];
-        _mm512_storeu_ps(vals, data);
-        return vals[index];
+        __m512 moved = _mm512_permutexvar_ps(_mm512_set1_epi32(static_cast<int>(index)), data);
+        return _mm_cvtss_f32(_mm512_castps512_ps128(moved));
     }
 
     // returns this * multiplier + addend
@@ -700,14 +1073,21 @@ struct SIMD_vecf {
         return os;
     }
 
-    // 8 packed floats per __m512
+    // 16 packed floats per __m512
     static int SIMD_vecf_size() {
-        return SIMD_VECTOR_SIZE;
+        return static_cast<int>(width);
     }
 
     // Destructor
     ~SIMD_vecf() = default;
 
+    // Calls body() from a function compiled for this backend's instruction set, with everything body calls inlined into it.
+    // This is how kernels written for any width run here even when the rest of the binary targets a narrower baseline
+    template <typename body_t>
+    static SIMD_FLATTEN void run_targeted(const body_t& body) {
+        body();
+    }
+
 
 
 
@@ -717,18 +1097,22 @@ private:
     SIMD_vecf(__m512 initial_data) : data(initial_data) {}
 
 
-    static const __m512 constants[6];
+
+    // One bit per lane for the first count lanes
+    static __mmask16 lane_mask(size_t count) {
+        return static_cast<__mmask16>((1u << count) - 1);
+    }
 
 
 
 };
 
-// Initialize the constants
-const __m512 SIMD_vecf::constants[6] = {
-    _mm512_set1_ps(1.4426950408889634f), // log2(e)
-    _mm512_set1_ps(1.0f),                // 1.0
-    _mm512_set1_ps(0.5f),                // 0.5
-    _mm512_set1_ps(0.3333333333333333f), // 1/3
-    _mm512_set1_ps(0.25f),               // 0.25
-    _mm512_set1_ps(0.0f)                 // 0.0
-};
+// if_true in the lanes where mask is set, if_false in the rest
+inline SIMD_vecf select(const SIMD_maskf& mask, const SIMD_vecf& if_true, const SIMD_vecf& if_false) {
+    SIMD_vecf result;
+    result.data = _mm512_mask_blend_ps(mask.data, if_false.data, if_true.data);
+    return result;
+}
+
+} // namespace SIMD_512
+SIMD_TARGET_END
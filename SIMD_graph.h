@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+
+/* Dependency tracking for compute_engine's kernel graphs (SIMD_graph, in compute_engine.h).
+
+A graph is a list of launches over one weaved_array, each declaring which of its arrays it reads and which it writes. The graph
+behaves as if they ran one after another in the order they were added, but a launch only has to wait for the earlier ones it
+conflicts with: those writing an array it reads or writes, or reading an array it writes. Launches that don't conflict are
+independent, and can run in any order or at the same time.
+
+Launches come in two kinds. Element-wise ones are kernels and transforms, which only touch element i of each array when working on
+element i. A dependency between two of them is then a dependency per element, so the engine fuses every element-wise launch it can
+into one pass over the arrays: the workers take the arrays a block at a time and run each launch of the pass over the block in order,
+while the block is still in cache, and launches that share nothing run side by side on different blocks. Whole-array launches, like
+a stencil, a scan or a reduction, may read any element, so they wait for everything they depend on to finish over the whole array
+and use the engine's workers to themselves.
+
+Usage:
+auto graph = make_SIMD_graph(arrays);
+graph.add_transform(SIMD_inputs<0>(), SIMD_outputs<1>(), [](auto x) { return x.exp(); });      // Fan out from arrays[0]
+graph.add_transform(SIMD_inputs<0>(), SIMD_outputs<2>(), [](auto x) { return x.sqrt(); });
+graph.add_launch({ 2 }, { 3 }, [&](compute_engine& engine) { engine.call_SIMD_stencil<2>(arrays, 2, 3, moving_average_kernel()); });
+graph.add_kernel({ 1, 3 }, { 1 }, [](auto** arrays, size_t index) { arrays[1][index] += arrays[3][index]; }); // Fan in
+engine.call_SIMD_graph(graph); // Both transforms in one pass, then the stencil, then the last kernel
+*/
+
+// One launch of a graph and the earlier launches it has to wait for
+struct SIMD_graph_node {
+    std::vector<size_t> reads;
+    std::vector<size_t> writes;
+    bool element_wise;
+    std::vector<size_t> dependencies;
+};
+
+// Whether later has to wait for earlier: one writes an array the other reads or writes
+inline bool SIMD_nodes_conflict(const SIMD_graph_node& earlier, const SIMD_graph_node& later) {
+    auto shares = [](const std::vector<size_t>& first, const std::vector<size_t>& second) {
+        for (size_t array : first) {
+            for (size_t other : second) {
+                if (array == other) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    return shares(earlier.writes, later.reads) || shares(earlier.writes, later.writes) || shares(earlier.reads, later.writes);
+}
+
+// What the engine runs next: element-wise nodes fused into one blocked pass, in order, or a single whole-array node
+struct SIMD_graph_step {
+    bool fused;
+    std::vector<size_t> nodes;
+};
+
+// Orders the nodes of a graph into steps. Every step fuses all element-wise nodes whose dependencies have already run or run in the
+// same pass, then runs each whole-array node that has become ready, and repeats until every node has run
+inline std::vector<SIMD_graph_step> SIMD_schedule_graph(const std::vector<SIMD_graph_node>& nodes) {
+    std::vector<SIMD_graph_step> steps;
+    std::vector<bool> done(nodes.size(), false);
+    size_t remaining = nodes.size();
+
+    // Dependencies always come earlier in the list, so one pass in order sees them before the nodes waiting on them
+    auto ready = [&](size_t node, const std::vector<bool>& also_done) {
+        for (size_t dependency : nodes[node].dependencies) {
+            if (!done[dependency] && !also_done[dependency]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    while (remaining > 0) {
+        SIMD_graph_step pass = { true, std::vector<size_t>() };
+        std::vector<bool> in_pass(nodes.size(), false);
+        for (size_t node = 0; node < nodes.size(); ++node) {
+            if (!done[node] && nodes[node].element_wise && ready(node, in_pass)) {
+                pass.nodes.push_back(node);
+                in_pass[node] = true;
+            }
+        }
+        for (size_t node : pass.nodes) {
+            done[node] = true;
+        }
+        remaining -= pass.nodes.size();
+        if (!pass.nodes.empty()) {
+            steps.push_back(pass);
+        }
+
+        for (size_t node = 0; node < nodes.size(); ++node) {
+            if (!done[node] && !nodes[node].element_wise && ready(node, done)) {
+                steps.push_back(SIMD_graph_step{ false, std::vector<size_t>(1, node) });
+                done[node] = true;
+                --remaining;
+            }
+        }
+    }
+    return steps;
+}
@@ -0,0 +1,711 @@
+/* Vectorized transcendental functions shared by every SIMD_vecf backend.
+
+SVML's _mm*_pow_ps, _mm*_sin_ps and friends only exist under MSVC and ICC, so the backends use these instead. This file has no include
+guard on purpose: each backend includes it inside its own namespace and target region, after defining the primitives it is written
+against (vfloat, vint, vmask, vadd, vselect, ...). The same source is compiled once per instruction set.
+
+The algorithms are Cody-Waite range reduction followed by the single precision minimax polynomials from Cephes. Maximum error measured
+against double precision over the stated domain, in ulps:
+
+exp     1.0   |x| < 88              exp2    1.0   |x| < 127             exp10   1.5   |x| < 38
+log     1.0   x > 0                 log2    2.0   x > 0                 log10   2.5   x > 0
+pow     2.5   results between 2^-126 and 2^128
+sin     2.5   |x| < 8192            cos     2.5   |x| < 8192            tan     3.5   |x| < 8192
+asin    2.5   |x| <= 1              acos    1.5   |x| <= 1              atan    3.0   all x
+atan2   3.5   all x, y except both infinite
+sinh    2.0   |x| < 88              cosh    1.5   |x| < 88              tanh    1.5   all x
+asinh   2.5   all x                 acosh   2.5   x >= 1                atanh   2.5   |x| < 1
+fmod    0     |x / y| < 2^24
+
+Trigonometric arguments beyond 8192 lose accuracy to the 4-part pi/4 reduction, and fmod with larger quotients is approximate.
+Results below FLT_MIN may be flushed to zero. NaN inputs produce NaN, except pow(x, 0) and pow(1, y), which are 1.
+*/
+
+namespace math {
+
+    // Cody-Waite splits: hi has trailing zero bits, so n * hi is exact for the n these are used with
+    static const float ln2_hi = 0.693359375f;
+    static const float ln2_lo = -2.12194440e-4f;
+    static const float log10_2_hi = 0.30102539f;
+    static const float log10_2_lo = 4.6050389e-6f;
+    static const float log2e = 1.44269504088896341f;
+    static const float log10e = 0.43429448190325182f;
+    static const float ln10 = 2.30258509299404568f;
+    static const float pi = 3.14159265358979324f;
+    static const float pi_2 = 1.57079632679489662f;
+    static const float pi_4 = 0.78539816339744831f;
+
+    inline vfloat vcopysign(vfloat magnitude, vfloat sign) {
+        vfloat sign_bit = vset(-0.0f);
+        return vor_bits(vandnot_bits(sign_bit, magnitude), vand_bits(sign_bit, sign));
+    }
+
+    inline vmask visnan(vfloat x) {
+        return vneq(x, x);
+    }
+
+    /* ----------------------------------------Exponentials---------------------------------------- */
+
+    // e^r for |r| <= ln(2) / 2
+    inline vfloat exp_poly(vfloat r) {
+        vfloat p = vset(1.9875691500E-4f);
+        p = vfma(p, r, vset(1.3981999507E-3f));
+        p = vfma(p, r, vset(8.3334519073E-3f));
+        p = vfma(p, r, vset(4.1665795894E-2f));
+        p = vfma(p, r, vset(1.6666665459E-1f));
+        p = vfma(p, r, vset(5.0000001201E-1f));
+        return vadd(vfma(p, vmul(r, r), r), vset(1.0f));
+    }
+
+    // p * 2^n for integral n in [-151, 128], in two steps so that neither power of two leaves the normal range
+    inline vfloat scale(vfloat p, vfloat n) {
+        vint e = vcvt_round(vmax(vmin(n, vset(128.0f)), vset(-151.0f)));
+        vint half = vsrai<1>(e);
+        vfloat first = vas_float(vshli<23>(vaddi(half, vseti(127))));
+        vfloat second = vas_float(vshli<23>(vaddi(vsubi(e, half), vseti(127))));
+        return vmul(vmul(p, first), second);
+    }
+
+    // Infinity above high, zero below low, NaN stays NaN
+    inline vfloat exp_limits(vfloat result, vfloat x, float high, float low) {
+        result = vselect(vgt(x, vset(high)), vset(INFINITY), result);
+        result = vselect(vlt(x, vset(low)), vset(0.0f), result);
+        return vselect(visnan(x), x, result);
+    }
+
+    inline vfloat exp(vfloat x) {
+        vfloat n = vround(vmul(x, vset(log2e)));
+        vfloat r = vfma(n, vset(-ln2_hi), x);
+        r = vfma(n, vset(-ln2_lo), r);
+        return exp_limits(scale(exp_poly(r), n), x, 88.72283905f, -103.972084f);
+    }
+
+    inline vfloat exp2(vfloat x) {
+        vfloat n = vround(x);
+        vfloat r = vmul(vsub(x, n), vset(0.693147180559945309f)); // x - n is exact
+        return exp_limits(scale(exp_poly(r), n), x, 128.0f, -150.0f);
+    }
+
+    inline vfloat exp10(vfloat x) {
+        vfloat n = vround(vmul(x, vset(3.32192809488736235f)));
+        vfloat r = vfma(n, vset(-log10_2_hi), x);
+        r = vfma(n, vset(-log10_2_lo), r);
+        return exp_limits(scale(exp_poly(vmul(r, vset(ln10))), n), x, 38.5318394f, -45.1544991f);
+    }
+
+    /* -------------------------------------------Logarithms------------------------------------------- */
+
+    // Splits positive, finite x into x = 2^e * (1 + f) with 1 + f in [sqrt(1/2), sqrt(2)). Handles subnormal x
+    inline void log_reduce(vfloat x, vfloat& e, vfloat& f) {
+        vmask subnormal = vlt(x, vset(1.17549435e-38f));
+        x = vselect(subnormal, vmul(x, vset(8388608.0f)), x); // 2^23
+
+        vint bits = vas_int(x);
+        vint exponent = vsubi(vsrli<23>(bits), vseti(126));
+        vfloat m = vas_float(vori(vandi(bits, vseti(0x007FFFFF)), vseti(0x3F000000))); // [0.5, 1)
+
+        e = vsub(vcvt_float(exponent), vselect(subnormal, vset(23.0f), vset(0.0f)));
+        vmask small = vlt(m, vset(0.707106781186547524f));
+        e = vsub(e, vselect(small, vset(1.0f), vset(0.0f)));
+        f = vsub(vadd(m, vselect(small, m, vset(0.0f))), vset(1.0f));
+    }
+
+    // log(1 + f) - f + f^2 / 2 for f in [sqrt(1/2) - 1, sqrt(2) - 1]
+    inline vfloat log_tail(vfloat f) {
+        vfloat p = vset(7.0376836292E-2f);
+        p = vfma(p, f, vset(-1.1514610310E-1f));
+        p = vfma(p, f, vset(1.1676998740E-1f));
+        p = vfma(p, f, vset(-1.2420140846E-1f));
+        p = vfma(p, f, vset(1.4249322787E-1f));
+        p = vfma(p, f, vset(-1.6668057665E-1f));
+        p = vfma(p, f, vset(2.0000714765E-1f));
+        p = vfma(p, f, vset(-2.4999993993E-1f));
+        p = vfma(p, f, vset(3.3333331174E-1f));
+        return vmul(vmul(p, f), vmul(f, f));
+    }
+
+    // NaN below zero, -infinity at zero, infinity at infinity
+    inline vfloat log_limits(vfloat result, vfloat x) {
+        result = vselect(vlt(x, vset(0.0f)), vset(NAN), result);
+        result = vselect(veq(x, vset(0.0f)), vset(-INFINITY), result);
+        result = vselect(veq(x, vset(INFINITY)), x, result);
+        return vselect(visnan(x), x, result);
+    }
+
+    inline vfloat log(vfloat x) {
+        vfloat e, f;
+        log_reduce(x, e, f);
+        vfloat y = vfma(e, vset(ln2_lo), log_tail(f));
+        y = vfma(vmul(f, f), vset(-0.5f), y);
+        y = vadd(f, y);
+        return log_limits(vfma(e, vset(ln2_hi), y), x);
+    }
+
+    inline vfloat log2(vfloat x) {
+        vfloat e, f;
+        log_reduce(x, e, f);
+        vfloat y = vadd(f, vfma(vmul(f, f), vset(-0.5f), log_tail(f)));
+        return log_limits(vfma(y, vset(log2e), e), x);
+    }
+
+    inline vfloat log10(vfloat x) {
+        vfloat e, f;
+        log_reduce(x, e, f);
+        vfloat y = vadd(f, vfma(vmul(f, f), vset(-0.5f), log_tail(f)));
+        y = vfma(e, vset(log10_2_lo), vmul(y, vset(log10e)));
+        return log_limits(vfma(e, vset(log10_2_hi), y), x);
+    }
+
+    // log(1 + x) without losing x to the rounding of 1 + x
+    inline vfloat log1p(vfloat x) {
+        vfloat u = vadd(x, vset(1.0f));
+        vfloat d = vsub(u, vset(1.0f));
+        vfloat corrected = vmul(log(u), vdiv(x, d));
+        return vselect(veq(d, vset(0.0f)), x, vselect(veq(u, vset(INFINITY)), u, corrected));
+    }
+
+    /* -------------------------------------------Powers------------------------------------------- */
+
+    // x^y = 2^(y * log2(x)). log2(x) is carried as hi + lo, so its rounding error isn't multiplied by y
+    inline vfloat pow(vfloat x, vfloat y) {
+        vfloat ax = vabs(x);
+        vfloat e, f;
+        log_reduce(ax, e, f);
+
+        // log(1 + f) = 2 atanh(s) = 2s + 2s^3 / 3 + 2s^5 / 5 + ..., s = f / (2 + f). The cephes polynomial in log() is only good
+        // to float precision, so this carries s as hi + lo and sums the series far enough for |s| <= 0.1716
+        vfloat d = vadd(vset(2.0f), f);
+        vfloat d_lo = vadd(vsub(vset(2.0f), d), f);
+        vfloat s_hi = vdiv(f, d);
+        vfloat product = vmul(s_hi, d);
+        vfloat residual = vsub(vsub(f, product), vprod_error(s_hi, d, product));
+        vfloat s_lo = vdiv(vfma(vneg(s_hi), d_lo, residual), d);
+
+        vfloat w = vmul(s_hi, s_hi);
+        vfloat series = vset(2.0f / 13.0f);
+        series = vfma(series, w, vset(2.0f / 11.0f));
+        series = vfma(series, w, vset(2.0f / 9.0f));
+        series = vfma(series, w, vset(2.0f / 7.0f));
+        series = vfma(series, w, vset(2.0f / 5.0f));
+        series = vfma(series, w, vset(2.0f / 3.0f));
+        vfloat ln_hi = vadd(s_hi, s_hi);
+        vfloat ln_lo = vfma(vmul(series, w), s_hi, vmul(s_lo, vfma(w, vset(2.0f), vset(2.0f)))); // 2s^3 / 3 moves by 2s^2 * s_lo
+        vfloat ln = vadd(ln_hi, ln_lo);
+        ln_lo = vadd(vsub(ln_hi, ln), ln_lo);
+        ln_hi = ln;
+
+        // log2(x) = e + log(1 + f) * log2(e)
+        vfloat l_hi = vmul(ln_hi, vset(log2e));
+        vfloat l_lo = vadd(vprod_error(ln_hi, vset(log2e), l_hi), vfma(ln_lo, vset(log2e), vmul(ln_hi, vset(1.925963033500011e-8f))));
+        vfloat t_hi = vadd(e, l_hi);
+        vfloat t_lo = vadd(vadd(vsub(e, t_hi), l_hi), l_lo); // |e| >= |l_hi| whenever e != 0
+
+        // z = y * log2(x)
+        vfloat z_hi = vmul(y, t_hi);
+        vfloat z_lo = vfma(y, t_lo, vprod_error(y, t_hi, z_hi));
+
+        vfloat n = vround(z_hi);
+        vfloat r = vmul(vadd(vsub(z_hi, n), z_lo), vset(0.693147180559945309f));
+        vfloat result = scale(exp_poly(r), n);
+        result = vselect(vgt(z_hi, vset(128.0f)), vset(INFINITY), result);
+        result = vselect(vlt(z_hi, vset(-151.0f)), vset(0.0f), result);
+
+        // log_reduce() only takes positive, finite x
+        vmask negative_y = vlt(y, vset(0.0f));
+        result = vselect(veq(ax, vset(0.0f)), vselect(negative_y, vset(INFINITY), vset(0.0f)), result);
+        result = vselect(veq(ax, vset(INFINITY)), vselect(negative_y, vset(0.0f), vset(INFINITY)), result);
+        result = vselect(vor_m(visnan(x), visnan(y)), vadd(x, y), result);
+
+        // Negative bases only have real powers for integral y, negative when y is odd
+        vmask integral = veq(vround(y), y);
+        vmask odd = vand_m(integral, vneq(vround(vmul(y, vset(0.5f))), vmul(y, vset(0.5f))));
+        vmask negative = vlt(x, vset(0.0f));
+        result = vselect(vand_m(negative, odd), vneg(result), result);
+        result = vselect(vand_m(negative, vnot_m(integral)), vset(NAN), result);
+
+        // 1 for y == 0 and x == 1 even when the other is NaN, and for (-1)^+-infinity
+        vmask one = vor_m(veq(y, vset(0.0f)), veq(x, vset(1.0f)));
+        one = vor_m(one, vand_m(veq(x, vset(-1.0f)), veq(vabs(y), vset(INFINITY))));
+        return vselect(one, vset(1.0f), result);
+    }
+
+    // x^N for N >= 0 by squaring, multiplied out at compile time: x^13 is 5 multiplies
+    template <unsigned int N>
+    struct power {
+        static vfloat of(vfloat x) {
+            vfloat half = power<N / 2>::of(x);
+            half = vmul(half, half);
+            return N % 2 == 1 ? vmul(half, x) : half;
+        }
+    };
+    template <>
+    struct power<1> {
+        static vfloat of(vfloat x) { return x; }
+    };
+    template <>
+    struct power<0> {
+        static vfloat of(vfloat) { return vset(1.0f); }
+    };
+
+    // x^(N / D) for D = 1 or 2. Negative N takes the reciprocal, D = 2 multiplies in one square root: x^(5/2) = x^2 * sqrt(x)
+    template <int N, int D>
+    inline vfloat pow(vfloat x) {
+        static_assert(D == 1 || D == 2, "pow<N, D>() takes whole and half exponents");
+        const unsigned int magnitude = N < 0 ? -N : N;
+        vfloat result = power<D == 2 ? magnitude / 2 : magnitude>::of(x);
+        if (D == 2 && magnitude % 2 == 1) {
+            result = magnitude == 1 ? vsqrt(x) : vmul(result, vsqrt(x));
+        }
+        return N < 0 ? vdiv(vset(1.0f), result) : result;
+    }
+
+    // pow(x, y) for a y known to be the same in every lane. Whole y in [-4, 4] is multiplied out like pow<N, 1>()
+    inline vfloat pow(vfloat x, float y) {
+        if (y >= -4.0f && y <= 4.0f && y == static_cast<float>(static_cast<int>(y))) {
+            switch (static_cast<int>(y)) {
+            case -4: return pow<-4, 1>(x);
+            case -3: return pow<-3, 1>(x);
+            case -2: return pow<-2, 1>(x);
+            case -1: return pow<-1, 1>(x);
+            case 0: return pow<0, 1>(x);
+            case 1: return x;
+            case 2: return pow<2, 1>(x);
+            case 3: return pow<3, 1>(x);
+            case 4: return pow<4, 1>(x);
+            }
+        }
+        return pow(x, vset(y));
+    }
+
+    inline vfloat fmod(vfloat x, vfloat y) {
+        vfloat q = vtrunc(vdiv(x, y));
+        vfloat product = vmul(q, y);
+        vfloat r = vsub(vsub(x, product), vprod_error(q, y, product));
+
+        // x / y may round across an integer; one step either way puts the remainder back in range with the sign of x
+        vfloat step = vcopysign(y, x);
+        vmask wrong_sign = vand_m(vneq(r, vset(0.0f)), vneq(vcopysign(vset(1.0f), r), vcopysign(vset(1.0f), x)));
+        r = vselect(wrong_sign, vadd(r, step), r);
+        r = vselect(vge(vabs(r), vabs(y)), vsub(r, step), r);
+        return vselect(veq(vabs(y), vset(INFINITY)), vselect(veq(vabs(x), vset(INFINITY)), vset(NAN), x), r);
+    }
+
+    /* -------------------------------------------Trigonometry------------------------------------------- */
+
+    // Reduces |x| to [-pi/4, pi/4]. Returns the octant, rounded up to even, that x was reduced from
+    inline vint trig_reduce(vfloat ax, vfloat& r) {
+        vint j = vcvt_trunc(vmul(ax, vset(1.27323954473516268f))); // 4 / pi
+        j = vandi(vaddi(j, vseti(1)), vseti(~1));
+        vfloat y = vcvt_float(j);
+        // pi/4 in four parts, the first three 10 bits wide so y * part is exact for y < 2^14 even without FMA
+        r = vfma(y, vset(-0.78515625f), ax);
+        r = vfma(y, vset(-2.4199485778808594e-4f), r);
+        r = vfma(y, vset(8.149072527885437e-8f), r);
+        r = vfma(y, vset(-3.038550253e-11f), r);
+        return j;
+    }
+
+    inline vfloat sin_poly(vfloat r, vfloat z) {
+        vfloat p = vset(-1.9515295891E-4f);
+        p = vfma(p, z, vset(8.3321608736E-3f));
+        p = vfma(p, z, vset(-1.6666654611E-1f));
+        return vfma(vmul(p, z), r, r);
+    }
+
+    inline vfloat cos_poly(vfloat z) {
+        vfloat p = vset(2.443315711809948E-5f);
+        p = vfma(p, z, vset(-1.388731625493765E-3f));
+        p = vfma(p, z, vset(4.166664568298827E-2f));
+        return vadd(vfma(vmul(p, z), z, vmul(z, vset(-0.5f))), vset(1.0f));
+    }
+
+    inline vfloat sin(vfloat x) {
+        vfloat r;
+        vint j = trig_reduce(vabs(x), r);
+        vfloat z = vmul(r, r);
+
+        vmask use_cos = veqi(vandi(j, vseti(2)), vseti(2));
+        vfloat result = vselect(use_cos, cos_poly(z), sin_poly(r, z));
+
+        vfloat flip = vas_float(vshli<29>(vandi(j, vseti(4))));
+        return vxor_bits(result, vxor_bits(flip, vand_bits(x, vset(-0.0f))));
+    }
+
+    inline vfloat cos(vfloat x) {
+        vfloat r;
+        vint j = vsubi(trig_reduce(vabs(x), r), vseti(2));
+        vfloat z = vmul(r, r);
+
+        vmask use_cos = veqi(vandi(j, vseti(2)), vseti(2));
+        vfloat result = vselect(use_cos, cos_poly(z), sin_poly(r, z));
+
+        vfloat flip = vas_float(vshli<29>(vandi(vxori(j, vseti(4)), vseti(4))));
+        return vxor_bits(result, flip);
+    }
+
+    inline vfloat tan(vfloat x) {
+        vfloat r;
+        vint j = trig_reduce(vabs(x), r);
+        vfloat z = vmul(r, r);
+
+        vfloat p = vset(9.38540185543E-3f);
+        p = vfma(p, z, vset(3.11992232697E-3f));
+        p = vfma(p, z, vset(2.44301354525E-2f));
+        p = vfma(p, z, vset(5.34112807005E-2f));
+        p = vfma(p, z, vset(1.33387994085E-1f));
+        p = vfma(p, z, vset(3.33331568548E-1f));
+        vfloat t = vfma(vmul(p, z), r, r);
+
+        vmask cotangent = veqi(vandi(j, vseti(2)), vseti(2));
+        t = vselect(cotangent, vdiv(vset(-1.0f), t), t);
+        return vxor_bits(t, vand_bits(x, vset(-0.0f)));
+    }
+
+    // asin(s) for |s| <= 0.5, given z = s^2
+    inline vfloat asin_poly(vfloat s, vfloat z) {
+        vfloat p = vset(4.2163199048E-2f);
+        p = vfma(p, z, vset(2.4181311049E-2f));
+        p = vfma(p, z, vset(4.5470025998E-2f));
+        p = vfma(p, z, vset(7.4953002686E-2f));
+        p = vfma(p, z, vset(1.6666752422E-1f));
+        return vfma(vmul(p, z), s, s);
+    }
+
+    inline vfloat asin(vfloat x) {
+        vfloat a = vabs(x);
+        vmask large = vgt(a, vset(0.5f));
+        vfloat z = vselect(large, vmul(vsub(vset(1.0f), a), vset(0.5f)), vmul(a, a));
+        vfloat s = vselect(large, vsqrt(z), a);
+        vfloat p = asin_poly(s, z);
+        vfloat result = vselect(large, vsub(vset(pi_2), vadd(p, p)), p);
+        return vcopysign(result, x);
+    }
+
+    inline vfloat acos(vfloat x) {
+        vfloat a = vabs(x);
+        vmask large = vgt(a, vset(0.5f));
+        vfloat z = vselect(large, vmul(vsub(vset(1.0f), a), vset(0.5f)), vmul(x, x));
+        vfloat s = vselect(large, vsqrt(z), x);
+        vfloat p = asin_poly(s, z);
+
+        vfloat large_result = vadd(p, p);
+        large_result = vselect(vlt(x, vset(0.0f)), vsub(vset(pi), large_result), large_result);
+        return vselect(large, large_result, vsub(vset(pi_2), p));
+    }
+
+    inline vfloat atan(vfloat x) {
+        vfloat a = vabs(x);
+        vmask above = vgt(a, vset(2.414213562373095f));            // tan(3pi/8)
+        vmask middle = vandnot_m(above, vgt(a, vset(0.4142135623730950f))); // tan(pi/8)
+
+        vfloat base = vselect(above, vset(pi_2), vselect(middle, vset(pi_4), vset(0.0f)));
+        a = vselect(above, vdiv(vset(-1.0f), a), vselect(middle, vdiv(vsub(a, vset(1.0f)), vadd(a, vset(1.0f))), a));
+
+        vfloat z = vmul(a, a);
+        vfloat p = vset(8.05374449538e-2f);
+        p = vfma(p, z, vset(-1.38776856032E-1f));
+        p = vfma(p, z, vset(1.99777106478E-1f));
+        p = vfma(p, z, vset(-3.33329491539E-1f));
+        vfloat result = vadd(base, vfma(vmul(p, z), a, a));
+        return vcopysign(result, x);
+    }
+
+    // atan(y / x) in the quadrant of (x, y)
+    inline vfloat atan2(vfloat y, vfloat x) {
+        vfloat result = atan(vdiv(y, x));
+        vmask negative_x = vlt(vcopysign(vset(1.0f), x), vset(0.0f));
+        result = vselect(negative_x, vadd(result, vcopysign(vset(pi), y)), result);
+
+        // 0 / 0: +-0 towards positive x, +-pi towards negative x
+        vmask zeroes = vand_m(veq(y, vset(0.0f)), veq(x, vset(0.0f)));
+        vfloat zero_result = vcopysign(vselect(negative_x, vset(pi), vset(0.0f)), y);
+        return vselect(zeroes, zero_result, result);
+    }
+
+    /* -------------------------------------------Hyperbolics------------------------------------------- */
+
+    inline vfloat sinh(vfloat x) {
+        vfloat a = vabs(x);
+        vfloat e = exp(a);
+        vfloat large = vsub(vmul(e, vset(0.5f)), vdiv(vset(0.5f), e));
+
+        vfloat z = vmul(a, a);
+        vfloat p = vset(2.03721912945E-4f);
+        p = vfma(p, z, vset(8.33028376239E-3f));
+        p = vfma(p, z, vset(1.66667160211E-1f));
+        vfloat small = vfma(vmul(p, z), a, a);
+
+        return vcopysign(vselect(vgt(a, vset(1.0f)), large, small), x);
+    }
+
+    inline vfloat cosh(vfloat x) {
+        vfloat e = exp(vabs(x));
+        return vadd(vmul(e, vset(0.5f)), vdiv(vset(0.5f), e));
+    }
+
+    inline vfloat tanh(vfloat x) {
+        vfloat a = vabs(x);
+        vfloat e = exp(vadd(a, a));
+        vfloat large = vsub(vset(1.0f), vdiv(vset(2.0f), vadd(e, vset(1.0f))));
+
+        vfloat z = vmul(a, a);
+        vfloat p = vset(-5.70498872745E-3f);
+        p = vfma(p, z, vset(2.06390887954E-2f));
+        p = vfma(p, z, vset(-5.37397155531E-2f));
+        p = vfma(p, z, vset(1.33314422036E-1f));
+        p = vfma(p, z, vset(-3.33332819422E-1f));
+        vfloat small = vfma(vmul(p, z), a, a);
+
+        return vcopysign(vselect(vgt(a, vset(0.625f)), large, small), x);
+    }
+
+    inline vfloat asinh(vfloat x) {
+        vfloat a = vabs(x);
+
+        // log(a + sqrt(a^2 + 1)) = log1p(a + a^2 / (1 + sqrt(a^2 + 1))), and log(2a) once a^2 + 1 == a^2
+        vfloat square = vmul(a, a);
+        vfloat middle = log1p(vadd(a, vdiv(square, vadd(vset(1.0f), vsqrt(vadd(square, vset(1.0f)))))));
+        vfloat huge = vadd(log(a), vset(0.693147180559945309f));
+
+        vfloat p = vset(2.0122003309E-2f);
+        p = vfma(p, square, vset(-4.2699340972E-2f));
+        p = vfma(p, square, vset(7.4847586088E-2f));
+        p = vfma(p, square, vset(-1.6666288134E-1f));
+        vfloat small = vfma(vmul(p, square), a, a);
+
+        vfloat result = vselect(vgt(a, vset(1500.0f)), huge, vselect(vlt(a, vset(0.5f)), small, middle));
+        return vcopysign(result, x);
+    }
+
+    inline vfloat acosh(vfloat x) {
+        vfloat z = vsub(x, vset(1.0f));
+
+        vfloat p = vset(1.7596881071E-3f);
+        p = vfma(p, z, vset(-7.5272886713E-3f));
+        p = vfma(p, z, vset(2.6454905019E-2f));
+        p = vfma(p, z, vset(-1.1784741703E-1f));
+        p = vfma(p, z, vset(1.4142135263E0f));
+        vfloat small = vmul(p, vsqrt(z));
+
+        vfloat middle = log(vadd(x, vsqrt(vmul(z, vadd(x, vset(1.0f))))));
+        vfloat huge = vadd(log(x), vset(0.693147180559945309f));
+
+        vfloat result = vselect(vgt(x, vset(1500.0f)), huge, vselect(vlt(z, vset(0.5f)), small, middle));
+        return vselect(vlt(x, vset(1.0f)), vset(NAN), result);
+    }
+
+    inline vfloat atanh(vfloat x) {
+        vfloat a = vabs(x);
+
+        vfloat z = vmul(a, a);
+        vfloat p = vset(1.81740078349E-1f);
+        p = vfma(p, z, vset(8.24370301058E-2f));
+        p = vfma(p, z, vset(1.46691431730E-1f));
+        p = vfma(p, z, vset(1.99782164500E-1f));
+        p = vfma(p, z, vset(3.33337300303E-1f));
+        vfloat small = vfma(vmul(p, z), a, a);
+
+        // 0.5 * log((1 + a) / (1 - a)) = 0.5 * log1p(2a / (1 - a))
+        vfloat large = vmul(vset(0.5f), log1p(vdiv(vadd(a, a), vsub(vset(1.0f), a))));
+
+        vfloat result = vselect(vlt(a, vset(0.5f)), small, large);
+        result = vselect(vgt(a, vset(1.0f)), vset(NAN), result);
+        return vcopysign(result, x);
+    }
+
+    /* -------------------------------------------Accuracy tiers------------------------------------------- */
+    // See SIMD_accuracy.h. The precise tier is the functions above
+
+    inline vfloat rcp(vfloat x, SIMD_fast_t) {
+        return vrcp(x);
+    }
+
+    // A Newton step is NaN where the estimate is 0 or infinity, and the estimate is already exact there
+    inline vfloat newton_fixup(vfloat estimate, vfloat refined) {
+        return vselect(visnan(refined), estimate, refined);
+    }
+
+    inline vfloat rcp(vfloat x, SIMD_standard_t) {
+        vfloat r = vrcp(x);
+        return newton_fixup(r, vfma(r, vfma(vneg(x), r, vset(1.0f)), r)); // r + r(1 - xr)
+    }
+
+    inline vfloat rcp(vfloat x, SIMD_precise_t) {
+        return vdiv(vset(1.0f), x);
+    }
+
+    inline vfloat rsqrt(vfloat x, SIMD_fast_t) {
+        return vrsqrt(x);
+    }
+
+    inline vfloat rsqrt(vfloat x, SIMD_standard_t) {
+        vfloat r = vrsqrt(x);
+        vfloat half_x_r = vmul(vmul(x, vset(0.5f)), r);
+        return newton_fixup(r, vmul(r, vfma(vneg(half_x_r), r, vset(1.5f)))); // r(1.5 - x r^2 / 2)
+    }
+
+    inline vfloat rsqrt(vfloat x, SIMD_precise_t) {
+        return vdiv(vset(1.0f), vsqrt(x));
+    }
+
+    // x * rsqrt(x) is NaN at 0 and infinity, where sqrt(x) == x
+    inline vfloat sqrt_fixup(vfloat x, vfloat result) {
+        return vselect(vor_m(veq(x, vset(0.0f)), veq(x, vset(INFINITY))), x, result);
+    }
+
+    inline vfloat sqrt(vfloat x, SIMD_fast_t) {
+        return sqrt_fixup(x, vmul(x, vrsqrt(x)));
+    }
+
+    inline vfloat sqrt(vfloat x, SIMD_standard_t) {
+        vfloat r = vrsqrt(x);
+        vfloat s = vmul(x, r);
+        vfloat half_r = vmul(r, vset(0.5f));
+        return sqrt_fixup(x, vfma(vfma(vneg(s), s, x), half_r, s)); // s + (x - s^2) r / 2
+    }
+
+    inline vfloat sqrt(vfloat x, SIMD_precise_t) {
+        return vsqrt(x);
+    }
+
+    // 2^n for integral n in [-127, 128], where -127 gives 0 and 128 infinity
+    inline vfloat pow2(vfloat n) {
+        return vas_float(vshli<23>(vaddi(vcvt_round(n), vseti(127))));
+    }
+
+    inline vfloat exp2(vfloat x, SIMD_fast_t) {
+        x = vmax(vmin(x, vset(128.0f)), vset(-127.0f));
+        vfloat n = vround(x);
+        vfloat f = vsub(x, n);
+        vfloat p = vset(5.517166722e-02f);
+        p = vfma(p, f, vset(2.426111221e-01f));
+        p = vfma(p, f, vset(6.932609858e-01f));
+        p = vfma(p, f, vset(9.999280736e-01f));
+        return vmul(p, pow2(n));
+    }
+
+    // 2^f for |f| <= 1/2
+    inline vfloat exp2_standard_poly(vfloat f) {
+        vfloat p = vset(1.327647171e-03f);
+        p = vfma(p, f, vset(9.675541332e-03f));
+        p = vfma(p, f, vset(5.550713274e-02f));
+        p = vfma(p, f, vset(2.402211972e-01f));
+        p = vfma(p, f, vset(6.931469671e-01f));
+        return vfma(p, f, vset(1.000000072e+00f));
+    }
+
+    inline vfloat exp2(vfloat x, SIMD_standard_t) {
+        x = vmax(vmin(x, vset(128.0f)), vset(-127.0f));
+        vfloat n = vround(x);
+        return vmul(exp2_standard_poly(vsub(x, n)), pow2(n));
+    }
+
+    inline vfloat exp(vfloat x, SIMD_fast_t tier) {
+        return exp2(vmul(x, vset(log2e)), tier);
+    }
+
+    // Reduces by n * ln(2) in two parts, so the error doesn't grow with |x| the way rounding x * log2(e) would
+    inline vfloat exp(vfloat x, SIMD_standard_t) {
+        x = vmax(vmin(x, vset(88.7228394f)), vset(-88.0296919f)); // 128 ln(2), -127 ln(2)
+        vfloat n = vround(vmul(x, vset(log2e)));
+        vfloat r = vfma(n, vset(-ln2_hi), x);
+        r = vfma(n, vset(-ln2_lo), r);
+        return vmul(exp2_standard_poly(vmul(r, vset(log2e))), pow2(n));
+    }
+
+    inline vfloat exp(vfloat x, SIMD_precise_t) {
+        return exp(x);
+    }
+
+    // Splits positive, normal x into x = 2^e * (1 + f), 1 + f in [sqrt(1/2), sqrt(2)), without log_reduce()'s subnormal handling
+    inline vfloat log2_reduce(vfloat x, vfloat& f) {
+        vint bits = vsubi(vas_int(x), vseti(0x3F3504F3)); // sqrt(1/2)
+        vint e = vsrai<23>(bits);
+        f = vsub(vas_float(vsubi(vas_int(x), vshli<23>(e))), vset(1.0f));
+        return vcvt_float(e);
+    }
+
+    inline vfloat log2(vfloat x, SIMD_fast_t) {
+        vfloat f;
+        vfloat e = log2_reduce(x, f);
+        vfloat p = vset(2.547517525e-01f);
+        p = vfma(p, f, vset(-3.908924127e-01f));
+        p = vfma(p, f, vset(4.853065270e-01f));
+        p = vfma(p, f, vset(-7.205549741e-01f));
+        p = vfma(p, f, vset(1.442646251e+00f));
+        return vfma(p, f, e);
+    }
+
+    inline vfloat log2(vfloat x, SIMD_standard_t) {
+        vfloat f;
+        vfloat e = log2_reduce(x, f);
+        vfloat p = vset(1.258370908e-01f);
+        p = vfma(p, f, vset(-2.072697887e-01f));
+        p = vfma(p, f, vset(2.157155986e-01f));
+        p = vfma(p, f, vset(-2.389448145e-01f));
+        p = vfma(p, f, vset(2.879162481e-01f));
+        p = vfma(p, f, vset(-3.607036831e-01f));
+        p = vfma(p, f, vset(4.809106430e-01f));
+        p = vfma(p, f, vset(-7.213473468e-01f));
+        p = vfma(p, f, vset(1.442695004e+00f));
+        return vfma(p, f, e);
+    }
+
+    inline vfloat log(vfloat x, SIMD_fast_t tier) {
+        return vmul(log2(x, tier), vset(0.693147180559945309f));
+    }
+
+    inline vfloat log(vfloat x, SIMD_standard_t tier) {
+        return vmul(log2(x, tier), vset(0.693147180559945309f));
+    }
+
+    inline vfloat log(vfloat x, SIMD_precise_t) {
+        return log(x);
+    }
+
+    inline vfloat pow(vfloat x, vfloat y, SIMD_fast_t tier) {
+        return exp2(vmul(y, log2(x, tier)), tier);
+    }
+
+    inline vfloat pow(vfloat x, vfloat y, SIMD_standard_t tier) {
+        return exp2(vmul(y, log2(x, tier)), tier);
+    }
+
+    inline vfloat pow(vfloat x, vfloat y, SIMD_precise_t) {
+        return pow(x, y);
+    }
+
+    // sin(x) = (-1)^j sin(x - j pi), with one odd polynomial over [-pi/2, pi/2] instead of the precise tier's two over [-pi/4, pi/4]
+    inline vfloat sin_reduced(vfloat r, vint j, vfloat p_of_r2) {
+        vfloat result = vmul(p_of_r2, r);
+        return vxor_bits(result, vas_float(vshli<31>(j)));
+    }
+
+    inline vfloat sin(vfloat x, SIMD_fast_t) {
+        vfloat n = vround(vmul(x, vset(0.318309886183790672f))); // 1 / pi
+        vfloat r = vfma(n, vset(-pi), x);
+        vfloat w = vmul(r, r);
+        vfloat p = vset(7.602937881e-03f);
+        p = vfma(p, w, vset(-1.659602277e-01f));
+        p = vfma(p, w, vset(9.998918957e-01f));
+        return sin_reduced(r, vcvt_round(n), p);
+    }
+
+    inline vfloat sin(vfloat x, SIMD_standard_t) {
+        vfloat n = vround(vmul(x, vset(0.318309886183790672f)));
+        vfloat r = vfma(n, vset(-3.140625f), x); // 8 bits, exact for |n| < 2^16
+        r = vfma(n, vset(-9.67653589793e-4f), r);
+        vfloat w = vmul(r, r);
+        vfloat p = vset(2.601905833e-06f);
+        p = vfma(p, w, vset(-1.980742029e-04f));
+        p = vfma(p, w, vset(8.333025169e-03f));
+        p = vfma(p, w, vset(-1.666665669e-01f));
+        p = vfma(p, w, vset(9.999999947e-01f));
+        return sin_reduced(r, vcvt_round(n), p);
+    }
+
+    inline vfloat sin(vfloat x, SIMD_precise_t) {
+        return sin(x);
+    }
+
+} // namespace math
@@ -0,0 +1,198 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#include <dirent.h>
+#include <cstdio>
+#endif
+
+
+/* NUMA topology and thread pinning for compute_engine's numa placement.
+
+On a machine with several memory nodes (usually one per socket) a page lives on the node of the thread that first wrote it, and a core
+reads its own node's memory at about twice the bandwidth of another's. numa_topology lists the CPUs this process may run on, grouped
+by node: from /sys/devices/system/node on Linux, GetNumaNodeProcessorMask on Windows (the first 64 CPUs), and as a single node of
+unknown CPUs anywhere else. No NUMA library is needed.
+
+Usage:
+numa_topology topology = numa_topology::detect();
+scoped_thread_pin pin;
+pin.pin(topology.nodes[0][0]); // The calling thread runs on node 0's first CPU until pin goes out of scope
+*/
+struct numa_topology {
+    // CPUs per node, in node order. Nodes without a CPU this process may use are left out
+    std::vector<std::vector<unsigned>> nodes;
+
+    size_t cpu_count() const {
+        size_t count = 0;
+        for (const auto& node : nodes) {
+            count += node.size();
+        }
+        return count;
+    }
+
+    static numa_topology detect();
+};
+
+// Restricts the calling thread to one CPU. Returns false where pinning isn't supported or the OS refused
+inline bool pin_thread(unsigned cpu) {
+#if defined(_WIN32)
+    return cpu < 64 && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Pins the calling thread with pin() and gives it back the CPUs it was allowed before on destruction
+class scoped_thread_pin {
+public:
+    scoped_thread_pin() : pinned(false) {}
+
+    scoped_thread_pin(const scoped_thread_pin&) = delete;
+    scoped_thread_pin& operator=(const scoped_thread_pin&) = delete;
+
+    void pin(unsigned cpu) {
+#if defined(_WIN32)
+        if (cpu < 64) {
+            previous = SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu);
+            pinned = previous != 0;
+        }
+#elif defined(__linux__)
+        pinned = sched_getaffinity(0, sizeof(previous), &previous) == 0 && pin_thread(cpu);
+#else
+        (void)cpu;
+#endif
+    }
+
+    ~scoped_thread_pin() {
+        if (!pinned) {
+            return;
+        }
+#if defined(_WIN32)
+        SetThreadAffinityMask(GetCurrentThread(), previous);
+#elif defined(__linux__)
+        sched_setaffinity(0, sizeof(previous), &previous);
+#endif
+    }
+
+private:
+    bool pinned;
+#if defined(_WIN32)
+    DWORD_PTR previous;
+#elif defined(__linux__)
+    cpu_set_t previous;
+#endif
+};
+
+inline numa_topology numa_topology::detect() {
+    numa_topology topology;
+
+#if defined(_WIN32)
+    ULONG highest = 0;
+    if (GetNumaHighestNodeNumber(&highest)) {
+        DWORD_PTR process_mask = 0, system_mask = 0;
+        GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask);
+        for (ULONG node = 0; node <= highest; ++node) {
+            ULONGLONG mask = 0;
+            if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask)) {
+                continue;
+            }
+            std::vector<unsigned> cpus;
+            for (unsigned cpu = 0; cpu < 64; ++cpu) {
+                if ((mask & process_mask) >> cpu & 1) {
+                    cpus.push_back(cpu);
+                }
+            }
+            if (!cpus.empty()) {
+                topology.nodes.push_back(cpus);
+            }
+        }
+    }
+#elif defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return topology;
+    }
+
+    // Node numbers can have gaps, so list the directory rather than counting up from node0
+    std::vector<std::pair<unsigned, std::vector<unsigned>>> found;
+    if (DIR* directory = opendir("/sys/devices/system/node")) {
+        while (dirent* entry = readdir(directory)) {
+            unsigned node;
+            char extra;
+            if (std::sscanf(entry->d_name, "node%u%c", &node, &extra) != 1) {
+                continue;
+            }
+
+            // cpulist looks like "0-15,32-47"
+            std::ifstream file(std::string("/sys/devices/system/node/") + entry->d_name + "/cpulist");
+            std::string list;
+            std::getline(file, list);
+
+            std::vector<unsigned> cpus;
+            const char* cursor = list.c_str();
+            while (*cursor >= '0' && *cursor <= '9') {
+                char* next;
+                unsigned first = static_cast<unsigned>(std::strtoul(cursor, &next, 10));
+                unsigned last = first;
+                if (*next == '-') {
+                    last = static_cast<unsigned>(std::strtoul(next + 1, &next, 10));
+                }
+                for (unsigned cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+                    if (CPU_ISSET(cpu, &allowed)) {
+                        cpus.push_back(cpu);
+                    }
+                }
+                cursor = *next == ',' ? next + 1 : next;
+            }
+            if (!cpus.empty()) {
+                found.push_back(std::make_pair(node, cpus));
+            }
+        }
+        closedir(directory);
+    }
+
+    std::sort(found.begin(), found.end());
+    for (auto& node : found) {
+        topology.nodes.push_back(node.second);
+    }
+
+    // No sysfs node directory: one node of every CPU we may use
+    if (topology.nodes.empty()) {
+        std::vector<unsigned> cpus;
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty()) {
+            topology.nodes.push_back(cpus);
+        }
+    }
+#endif
+
+    return topology;
+}
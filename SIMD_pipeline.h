@@ -0,0 +1,104 @@
+#pragma once
+#include <tuple>
+#include <string>
+#include <fstream>
+#include <cstddef>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <vector>
+#endif
+
+
+/* Kernels chained over the same arrays, for compute_engine::call_SIMD_pipeline.
+
+Launching kernels one after another over arrays larger than the caches brings every array in from memory once per kernel. A pipeline
+runs all of its stages over one block of the arrays before moving on to the next, so every stage after the first finds the block
+still in the L2 cache and the arrays are read from and written to memory once, however many stages there are.
+
+Stages are kernels as call_SIMD_operation takes them: SIMD_operation functions, or lambdas and functors called as stage(arrays,
+index), which may only touch vector index of each array. They run in the order they are listed, and every element sees them in that
+order, but neighbouring elements may already be further along the pipeline.
+
+block_bytes is how much of all the arrays together makes up a block. It defaults to half the L2 cache of a core, leaving the rest for
+whatever the stages use besides the arrays.
+
+Usage:
+auto pipeline = make_SIMD_pipeline(pythagorean_theorum, scale_kernel(), [](auto** arrays, size_t index) { arrays[1][index] = arrays[0][index].sqrt(); });
+engine.call_SIMD_pipeline(arrays, pipeline);   // One pass over arrays rather than three
+pipeline.block_bytes = 128 * 1024;              // Blocks of 128KB instead
+*/
+template <typename... stages_t>
+struct SIMD_pipeline {
+    static_assert(sizeof...(stages_t) > 0, "a pipeline needs at least one stage");
+
+    std::tuple<stages_t...> stages;
+
+    // Bytes of all arrays together run through every stage at once. 0 is half the L2 cache, SIMD_l2_cache_size() / 2
+    size_t block_bytes;
+
+    explicit SIMD_pipeline(const stages_t&... stages) : stages(stages...), block_bytes(0) {}
+};
+
+// Functions are kept as SIMD_operation pointers, kernel objects by value
+template <typename... stages_t>
+SIMD_pipeline<stages_t...> make_SIMD_pipeline(stages_t... stages) {
+    return SIMD_pipeline<stages_t...>(stages...);
+}
+
+// Size in bytes of the first CPU's L2 data cache, from /sys/devices/system/cpu on Linux and GetLogicalProcessorInformation on
+// Windows. 256KB where the platform can't tell
+inline size_t SIMD_detect_l2_cache_size() {
+#if defined(_WIN32)
+    DWORD length = 0;
+    GetLogicalProcessorInformation(nullptr, &length);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> processors(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!processors.empty() && GetLogicalProcessorInformation(processors.data(), &length)) {
+        for (const auto& processor : processors) {
+            if (processor.Relationship == RelationCache && processor.Cache.Level == 2 && processor.Cache.Type != CacheInstruction) {
+                return processor.Cache.Size;
+            }
+        }
+    }
+#elif defined(__linux__)
+    for (int index = 0; ; ++index) {
+        std::string directory = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+        std::ifstream level_file(directory + "level");
+        if (!level_file) {
+            break;
+        }
+        int level = 0;
+        level_file >> level;
+
+        std::ifstream type_file(directory + "type");
+        std::string type;
+        type_file >> type;
+        if (level != 2 || type == "Instruction") {
+            continue;
+        }
+
+        // size looks like "2048K"
+        std::ifstream size_file(directory + "size");
+        size_t size = 0;
+        char unit = 0;
+        size_file >> size >> unit;
+        size <<= unit == 'K' ? 10 : unit == 'M' ? 20 : 0;
+        if (size > 0) {
+            return size;
+        }
+    }
+#endif
+    return 256 * 1024;
+}
+
+// SIMD_detect_l2_cache_size(), looked up on the first call only
+inline size_t SIMD_l2_cache_size() {
+    static const size_t size = SIMD_detect_l2_cache_size();
+    return size;
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include "SIMD_float.h"
+#include <cmath>
+#include <cstdint>
+
+
+/* Reductions for compute_engine::call_SIMD_reduce.
+
+A reduction folds the vectors a map produces into a single result. Each worker keeps accumulators of the backend's vector type, so
+lanes are combined with vector instructions all the way through a chunk; only the last accumulator of a chunk is folded lane by lane,
+and the chunks' results are then merged into one.
+
+Besides the ones here, any type with the same members works:
+
+result_type                          What the reduction returns
+empty()                              The result of reducing no elements
+merge(a, b)                          Combines two results. a comes from earlier elements than b when that matters (argmin)
+accumulator<vec_t>                   Default constructs to the empty state and has
+    identity()                       A vector that leaves the accumulator unchanged, put in the lanes past the end of the arrays
+    add(value, offset)               Folds in one vector, the offset-th of its block
+    merge(other)                     Folds in another accumulator of the same block
+    result(first_vector)             The block's result, where first_vector is the index of the block's first vector
+
+Usage:
+compute_engine engine;
+float total = engine.call_SIMD_reduce(inputs, [](auto** arrays, size_t index) { return arrays[0][index] * arrays[1][index]; }, SIMD_reductions::sum());
+SIMD_arg_result lowest = engine.reduce_argmin(inputs, 0); // lowest.value == inputs.get(0, lowest.index)
+*/
+
+// The smallest or largest element and where it is, from reduce_argmin() and reduce_argmax(). Ties go to the lowest index.
+// index is SIZE_MAX when no element is below (above) infinity, e.g. every element is NaN
+struct SIMD_arg_result {
+    float value;
+    size_t index;
+};
+
+namespace SIMD_reductions {
+
+    // Sum of every lane. Four accumulators of SIMD_VECTOR_SIZE lanes each make for a blocked summation, which loses far less to rounding
+    // than adding into one float, but the order chunks are merged in depends on scheduling, so the last bits can vary between runs
+    struct sum {
+        typedef float result_type;
+
+        static result_type empty() { return 0.0f; }
+        static result_type merge(result_type a, result_type b) { return a + b; }
+
+        template <typename vec_t>
+        struct accumulator {
+            vec_t total;
+
+            accumulator() : total(0.0f) {}
+
+            static vec_t identity() { return vec_t(0.0f); }
+            void add(const vec_t& value, float) { total += value; }
+            void merge(const accumulator& other) { total += other.total; }
+
+            result_type result(size_t) const { return total.hsum(); }
+        };
+    };
+
+    // Smallest (largest) lane. NaNs are skipped; infinity (-infinity) if every lane is NaN
+    template <bool largest>
+    struct extreme {
+        typedef float result_type;
+
+        static bool before(float a, float b) { return largest ? a > b : a < b; }
+
+        static result_type empty() { return largest ? -INFINITY : INFINITY; }
+        static result_type merge(result_type a, result_type b) { return before(b, a) ? b : a; }
+
+        template <typename vec_t>
+        struct accumulator {
+            vec_t best;
+
+            accumulator() : best(empty()) {}
+
+            static vec_t identity() { return vec_t(empty()); }
+            void add(const vec_t& value, float) { best = select(largest ? value > best : value < best, value, best); }
+            void merge(const accumulator& other) { add(other.best, 0.0f); }
+
+            // add() never lets a NaN in, so hmin() and hmax() are well defined here
+            result_type result(size_t) const { return largest ? best.hmax() : best.hmin(); }
+        };
+    };
+
+    // Smallest (largest) lane and its element index. Each lane remembers which vector of the block its best value came from
+    template <bool largest>
+    struct arg_extreme {
+        typedef SIMD_arg_result result_type;
+
+        static result_type empty() {
+            result_type none = { largest ? -INFINITY : INFINITY, SIZE_MAX };
+            return none;
+        }
+        static result_type merge(result_type a, result_type b) {
+            bool b_first = extreme<largest>::before(b.value, a.value) || (b.value == a.value && b.index < a.index);
+            return b_first ? b : a;
+        }
+
+        template <typename vec_t>
+        struct accumulator {
+            vec_t best;
+            vec_t offset; // Vector offset of best within the block, exact as a float because blocks are shorter than 2^24 vectors
+
+            accumulator() : best(empty().value), offset(0.0f) {}
+
+            static vec_t identity() { return vec_t(empty().value); }
+
+            void add(const vec_t& value, float value_offset) {
+                typename vec_t::mask_type better = largest ? value > best : value < best;
+                best = select(better, value, best);
+                offset = select(better, vec_t(value_offset), offset);
+            }
+
+            void merge(const accumulator& other) {
+                typename vec_t::mask_type better = largest ? other.best > best : other.best < best;
+                better = better | ((other.best == best) & (other.offset < offset));
+                best = select(better, other.best, best);
+                offset = select(better, other.offset, offset);
+            }
+
+            result_type result(size_t first_vector) const {
+                result_type found = empty();
+                for (size_t lane = 0; lane < vec_t::width; ++lane) {
+                    float value = best[lane];
+                    // A lane still at the empty value never saw an element, so its offset means nothing
+                    if (extreme<largest>::before(value, empty().value)) {
+                        result_type candidate = { value, (first_vector + static_cast<size_t>(offset[lane])) * vec_t::width + lane };
+                        found = arg_extreme::merge(found, candidate);
+                    }
+                }
+                return found;
+            }
+        };
+    };
+
+    typedef extreme<false> min;
+    typedef extreme<true> max;
+    typedef arg_extreme<false> argmin;
+    typedef arg_extreme<true> argmax;
+}
+
+/* ---------------------------------------------Maps--------------------------------------------- */
+
+// arrays[array]
+struct SIMD_element_map {
+    size_t array;
+
+    template <typename vec_t>
+    vec_t operator()(vec_t** arrays, size_t index) const {
+        return arrays[array][index];
+    }
+};
+
+// arrays[first] * arrays[second], for dot products
+struct SIMD_product_map {
+    size_t first;
+    size_t second;
+
+    template <typename vec_t>
+    vec_t operator()(vec_t** arrays, size_t index) const {
+        return arrays[first][index] * arrays[second][index];
+    }
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include "SIMD_float.h"
+#include <cmath>
+#include <utility>
+
+
+/* Operators for compute_engine::call_SIMD_scan.
+
+A scan writes every prefix of an array: with sum, output[i] = input[0] + input[1] + ... + input[i]. The engine scans chunks of the
+array in parallel, each from the operator's identity, then adds every chunk's carry (the scan of all the chunks before it) in a second
+parallel pass. Within a vector the lanes are scanned in log2(width) steps of shift and combine, so a whole vector is scanned in registers.
+
+An operator needs an identity() and combine() for floats and for every vector type. combine must be associative. It may also have a
+prepare() for vectors, which every input vector goes through before it is scanned.
+
+Usage:
+compute_engine engine;
+engine.call_SIMD_scan(inputs, 0, 1, SIMD_scans::sum());                          // arrays[1] = running total of arrays[0]
+engine.call_SIMD_scan(inputs, 0, 0, SIMD_scans::max(), SIMD_scan_mode::exclusive); // In place, largest element before each one
+*/
+
+// Inclusive scans include input[i] in output[i], exclusive scans stop at input[i - 1] and start from the identity
+enum class SIMD_scan_mode {
+    inclusive,
+    exclusive
+};
+
+namespace SIMD_scans {
+
+    struct sum {
+        static float identity() { return 0.0f; }
+        static float combine(float a, float b) { return a + b; }
+
+        template <typename vec_t>
+        static vec_t combine(const vec_t& a, const vec_t& b) { return a + b; }
+    };
+
+    // NaNs are skipped, as in the min and max reductions: prepare() turns them into the identity, since the lane scan would otherwise
+    // carry a NaN from a lower lane on as a. Where the input is NaN the output is the scan of the elements before it
+    struct max {
+        static float identity() { return -INFINITY; }
+        static float combine(float a, float b) { return b > a ? b : a; }
+
+        template <typename vec_t>
+        static vec_t prepare(const vec_t& value) { return select(value == value, value, vec_t(identity())); }
+
+        template <typename vec_t>
+        static vec_t combine(const vec_t& a, const vec_t& b) { return select(b > a, b, a); }
+    };
+
+    struct min {
+        static float identity() { return INFINITY; }
+        static float combine(float a, float b) { return b < a ? b : a; }
+
+        template <typename vec_t>
+        static vec_t prepare(const vec_t& value) { return select(value == value, value, vec_t(identity())); }
+
+        template <typename vec_t>
+        static vec_t combine(const vec_t& a, const vec_t& b) { return select(b < a, b, a); }
+    };
+}
+
+// op_t::prepare(value) for operators that have one, value unchanged for the others
+template <typename op_t, typename vec_t, typename = void>
+struct SIMD_scan_input {
+    static vec_t prepare(const vec_t& value) { return value; }
+};
+
+template <typename op_t, typename vec_t>
+struct SIMD_scan_input<op_t, vec_t, decltype(void(op_t::prepare(std::declval<const vec_t&>())))> {
+    static vec_t prepare(const vec_t& value) { return op_t::prepare(value); }
+};
+
+// Inclusive scan of the lanes of a vector: lane i of the result combines lanes 0 through i. Each step combines every lane with the one
+// shift lanes below it, doubling shift until it covers the vector
+template <typename op_t, typename vec_t, int shift = 1, bool done = (shift >= static_cast<int>(vec_t::width))>
+struct SIMD_lane_scan {
+    static vec_t apply(const vec_t& value) {
+        vec_t shifted = select(vec_t::mask_type::first(shift), vec_t(op_t::identity()), value.template shift_up<shift>());
+        return SIMD_lane_scan<op_t, vec_t, shift * 2>::apply(op_t::combine(shifted, value));
+    }
+};
+
+template <typename op_t, typename vec_t, int shift>
+struct SIMD_lane_scan<op_t, vec_t, shift, true> {
+    static vec_t apply(const vec_t& value) {
+        return value;
+    }
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "SIMD_float.h"
+
+
+/* Neighbourhood access for compute_engine::call_SIMD_stencil.
+
+A stencil computes every vector of an output array from the elements around the same position in an input array: moving averages,
+finite differences, 1D convolutions. The kernel gets a SIMD_window centred on the vector it computes and returns the output vector.
+window.at(k) is the vector starting k elements further along, an unaligned load straight from the input array, so a kernel with
+radius 2 reads five overlapping vectors per output vector.
+
+The input is only read and the output only written, each output vector by exactly one thread, so chunks need no overlap or
+synchronization. Near either end of the array the window is staged through a small buffer padded with the boundary value passed to
+call_SIMD_stencil, which stands in for elements outside the array, and the kernel still runs on whole vectors.
+
+Usage:
+struct moving_average {
+    template <typename vec_t>
+    vec_t operator()(const SIMD_window<vec_t, 1>& in) const {
+        return (in.at(-1) + in.at(0) + in.at(1)) * vec_t(1.0f / 3.0f);
+    }
+};
+engine.call_SIMD_stencil<1>(inputs, 0, 1, moving_average()); // arrays[1] = 3-point moving average of arrays[0]
+*/
+template <typename vec_t, int radius>
+class SIMD_window {
+public:
+    static_assert(radius >= 0, "a stencil's radius can't be negative");
+
+    explicit SIMD_window(const float* center) : center(center) {}
+
+    // Elements offset to offset + width - 1 from the start of the output vector. offset must be in [-radius, radius]
+    vec_t at(int offset) const {
+        return vec_t(center + offset);
+    }
+
+    // Same, with the offset checked at compile time. Templated kernels spell it in.template at<1>()
+    template <int offset>
+    vec_t at() const {
+        static_assert(offset >= -radius && offset <= radius, "offset is outside the stencil's radius");
+        return vec_t(center + offset);
+    }
+
+private:
+    const float* center;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+/* Lets the SSE, AVX2 and AVX-512 backends live in the same binary regardless of the compiler flags it is built with.
+
+MSVC accepts any intrinsic in any function, so these expand to nothing there. GCC and Clang only allow an intrinsic inside a function
+compiled for its instruction set, so each backend header wraps its code in SIMD_TARGET_BEGIN_<isa> / SIMD_TARGET_END.
+
+None of the code inside a target region may run before the dispatcher in SIMD_float.h has checked that the CPU supports it, which is
+also why the backends don't keep namespace-scope vector constants: their initializers would run at startup on every host.
+*/
+#if defined(__clang__)
+#define SIMD_TARGET_BEGIN_SSE _Pragma("clang attribute push (__attribute__((target(\"sse4.1\"))), apply_to = function)")
+#define SIMD_TARGET_BEGIN_AVX2 _Pragma("clang attribute push (__attribute__((target(\"avx2,fma\"))), apply_to = function)")
+#define SIMD_TARGET_BEGIN_AVX512 _Pragma("clang attribute push (__attribute__((target(\"avx512f,avx2,fma\"))), apply_to = function)")
+#define SIMD_TARGET_END _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+#define SIMD_TARGET_BEGIN_SSE _Pragma("GCC push_options") _Pragma("GCC target(\"sse4.1\")")
+#define SIMD_TARGET_BEGIN_AVX2 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma\")")
+#define SIMD_TARGET_BEGIN_AVX512 _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f,avx2,fma\")")
+#define SIMD_TARGET_END _Pragma("GCC pop_options")
+#else
+#define SIMD_TARGET_BEGIN_SSE
+#define SIMD_TARGET_BEGIN_AVX2
+#define SIMD_TARGET_BEGIN_AVX512
+#define SIMD_TARGET_END
+#endif
+
+// Inlines everything a function calls, and everything those calls call, into it. A kernel written for any width then gets compiled
+// for the instruction set of the backend's run_targeted() it is instantiated in, instead of being called across a target boundary.
+// Dispatch relies on every call inside a kernel being inlined: a helper taking a vec_t that is noinline, recursive, virtual or called
+// through a function pointer stays compiled for the build's own instruction set, and breaks the wider backends even in optimized builds
+#if defined(__GNUC__)
+#define SIMD_FLATTEN __attribute__((flatten))
+#else
+#define SIMD_FLATTEN
+#endif
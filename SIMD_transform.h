@@ -0,0 +1,101 @@
+#pragma once
+#include "SIMD_float.h"
+#include <array>
+#include <type_traits>
+#include <cstddef>
+
+
+/* Out-of-place kernels for compute_engine::call_SIMD_transform.
+
+A kernel passed to call_SIMD_operation gets every array by reference, so the engine has to assume it reads and writes all of them,
+and arrays that are still needed afterwards have to be copied before the launch. A transform kernel instead takes the vectors of its
+input arrays by value and returns the vectors of its output arrays:
+
+    vec_t kernel(in_0, in_1, ...)                   One output
+    std::array<vec_t, n> kernel(in_0, in_1, ...)    n outputs, in the order SIMD_outputs lists them
+
+The call names the arrays with SIMD_inputs and SIMD_outputs. Inputs are only loaded and outputs only stored, so an output's old
+contents never have to come in from memory, and with streaming stores (see SIMD_store_mode) the results don't pass through the cache
+either. An array may be both an input and an output, which updates it in place.
+
+Usage:
+struct hypotenuse {
+    template <typename vec_t>
+    vec_t operator()(const vec_t& x, const vec_t& y) const {
+        return (x * x + y * y).sqrt();
+    }
+};
+engine.call_SIMD_transform(arrays, SIMD_inputs<0, 1>(), SIMD_outputs<2>(), hypotenuse()); // arrays[2] = hypot(arrays[0], arrays[1])
+*/
+
+// Indices of arrays in a weaved_array, checked at compile time by call_SIMD_transform
+template <size_t... arrays>
+struct SIMD_array_list {
+    static const size_t count = sizeof...(arrays);
+
+    static constexpr bool below(size_t bound) {
+        const size_t list[] = { arrays..., 0 };
+        for (size_t i = 0; i < count; ++i) {
+            if (list[i] >= bound) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static constexpr bool contains(size_t array) {
+        const size_t list[] = { arrays..., 0 };
+        for (size_t i = 0; i < count; ++i) {
+            if (list[i] == array) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static constexpr bool distinct() {
+        const size_t list[] = { arrays..., 0 };
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = i + 1; j < count; ++j) {
+                if (list[i] == list[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+template <size_t... arrays>
+struct SIMD_inputs : SIMD_array_list<arrays...> {};
+
+template <size_t... arrays>
+struct SIMD_outputs : SIMD_array_list<arrays...> {};
+
+// Output vectors in what a transform kernel returns, and their type
+template <typename result_t>
+struct SIMD_result_count : std::integral_constant<size_t, 1> {};
+
+template <typename vec_t, size_t count>
+struct SIMD_result_count<std::array<vec_t, count>> : std::integral_constant<size_t, count> {};
+
+template <typename result_t>
+struct SIMD_result_vector {
+    typedef result_t type;
+};
+
+template <typename vec_t, size_t count>
+struct SIMD_result_vector<std::array<vec_t, count>> {
+    typedef vec_t type;
+};
+
+// The k-th output vector of what a transform kernel returned
+template <typename vec_t>
+const vec_t& SIMD_result_at(const vec_t& result, size_t) {
+    return result;
+}
+
+template <typename vec_t, size_t count>
+const vec_t& SIMD_result_at(const std::array<vec_t, count>& result, size_t k) {
+    return result[k];
+}
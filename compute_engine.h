@@ -1,59 +1,2295 @@
+#pragma once
 #include "SIMD_float.h"
+#include "SIMD_expression.h"
+#include "SIMD_reduce.h"
+#include "SIMD_scan.h"
+#include "SIMD_stencil.h"
+#include "SIMD_fill.h"
+#include "SIMD_transform.h"
+#include "SIMD_pipeline.h"
+#include "SIMD_graph.h"
+#include "SIMD_async.h"
+#include "SIMD_allocator.h"
+#include "SIMD_numa.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+#include <cstdint>
 
+// A kernel: processes vector index of every array in place. Lanes past the end of the arrays hold zeroes and are discarded
+typedef void (*SIMD_operation)(SIMD_vecf**, size_t);
 
-template <typename T, size_t num_arrays, size_t array_size>
+// Lambdas and functors with the same signature as SIMD_operation. They get their own overloads so the kernel inlines into the loop
+template <typename operation_t>
+struct is_SIMD_kernel_object : std::is_class<typename std::decay<operation_t>::type> {};
+
+template <typename...>
+struct SIMD_void {
+    typedef void type;
+};
+
+// Kernel objects that compile for every backend, like [](auto** arrays, size_t index) { ... } or a functor with a templated
+// operator(). These are dispatched to the widest backend the CPU supports instead of SIMD_vecf.
+template <typename operation_t, typename = void>
+struct is_width_generic_kernel : std::false_type {};
+
+template <typename operation_t>
+struct is_width_generic_kernel<operation_t, typename SIMD_void<
+    decltype(std::declval<const operation_t&>()(std::declval<SIMD_128::SIMD_vecf**>(), size_t())),
+    decltype(std::declval<const operation_t&>()(std::declval<SIMD_256::SIMD_vecf**>(), size_t())),
+    decltype(std::declval<const operation_t&>()(std::declval<SIMD_512::SIMD_vecf**>(), size_t()))>::type> : std::true_type {};
+
+// Fill producers written for any width, like [](auto& value, size_t first) { ... }, dispatched the same way
+template <typename producer_t, typename = void>
+struct is_width_generic_producer : std::false_type {};
+
+template <typename producer_t>
+struct is_width_generic_producer<producer_t, typename SIMD_void<
+    decltype(std::declval<const producer_t&>()(std::declval<SIMD_128::SIMD_vecf&>(), size_t())),
+    decltype(std::declval<const producer_t&>()(std::declval<SIMD_256::SIMD_vecf&>(), size_t())),
+    decltype(std::declval<const producer_t&>()(std::declval<SIMD_512::SIMD_vecf&>(), size_t()))>::type> : std::true_type {};
+
+// T, once per element of a parameter pack
+template <typename T, size_t>
+struct SIMD_repeat {
+    typedef T type;
+};
+
+// Whether kernel_t takes one vec_t per input array and returns vec_t results
+template <typename kernel_t, typename vec_t, typename inputs_t, typename = void>
+struct is_SIMD_transform_of_width : std::false_type {};
+
+template <typename kernel_t, typename vec_t, size_t... inputs>
+struct is_SIMD_transform_of_width<kernel_t, vec_t, SIMD_inputs<inputs...>, typename SIMD_void<
+    decltype(std::declval<const kernel_t&>()(std::declval<typename SIMD_repeat<vec_t, inputs>::type>()...))>::type>
+    : std::is_same<typename SIMD_result_vector<typename std::decay<decltype(std::declval<const kernel_t&>()(std::declval<typename SIMD_repeat<vec_t, inputs>::type>()...))>::type>::type, vec_t> {};
+
+// Transform kernels written for any width, taking one vector per input array, like [](auto x, auto y) { return x * y; }
+template <typename kernel_t, typename inputs_t>
+struct is_width_generic_transform : std::integral_constant<bool,
+    is_SIMD_transform_of_width<kernel_t, SIMD_128::SIMD_vecf, inputs_t>::value &&
+    is_SIMD_transform_of_width<kernel_t, SIMD_256::SIMD_vecf, inputs_t>::value &&
+    is_SIMD_transform_of_width<kernel_t, SIMD_512::SIMD_vecf, inputs_t>::value> {};
+
+// Pipelines whose stages are all width-generic kernels. One SIMD_operation among them keeps the whole pipeline at SIMD_vecf
+template <typename... stages_t>
+struct is_width_generic_pipeline : std::true_type {};
+
+template <typename stage_t, typename... stages_t>
+struct is_width_generic_pipeline<stage_t, stages_t...> : std::integral_constant<bool,
+    is_width_generic_kernel<stage_t>::value && is_width_generic_pipeline<stages_t...>::value> {};
+
+// How a launch stores the vectors it writes
+enum class SIMD_store_mode {
+    automatic, // Non-temporal once the data written is bigger than SIMD_STREAM_MIN_BYTES, through the caches below that
+    cached,    // Normal stores, leaving the result in cache for whatever reads it next
+    streaming  // Non-temporal stores straight to memory, for results that won't be read again soon
+};
+
+// Bytes written above which SIMD_store_mode::automatic streams. Below it the result likely still fits in the last level cache
+#define SIMD_STREAM_MIN_BYTES (1 << 23)
+
+// Bytes the hardware moves between memory and cache at a time, and so the granularity of software prefetches
+#define SIMD_CACHE_LINE_SIZE 64
+
+// Tuning for a single kernel launch. Converts from a SIMD_store_mode, so launches that only pick how results are stored can pass one
+struct SIMD_launch_options {
+    // How the results are stored
+    SIMD_store_mode store_mode;
+
+    // Vectors each loop iteration hands to the kernel back to back: 1, 2, 4 or 8. Independent vectors in flight let long-latency
+    // instructions (div, sqrt) of one overlap with the next. Streaming in-place launches ignore it
+    size_t unroll;
+
+    // Elements ahead of the one being processed that every array the kernel reads is prefetched from, 0 for none. Hardware prefetchers
+    // already follow plain streams well, so this mostly pays off with many arrays or tiled layouts
+    size_t prefetch_distance;
+
+    SIMD_launch_options(SIMD_store_mode store_mode = SIMD_store_mode::cached, size_t unroll = 1, size_t prefetch_distance = 0)
+        : store_mode(store_mode), unroll(unroll), prefetch_distance(prefetch_distance) {}
+};
+
+// Prefetches the cache lines of count vectors starting at vectors into L1. Prefetches never fault, so addresses past the end are fine
+template <typename vec_t>
+inline void SIMD_prefetch(const vec_t* vectors, size_t count) {
+    const char* bytes = reinterpret_cast<const char*>(vectors);
+    for (size_t offset = 0; offset < count * sizeof(vec_t); offset += SIMD_CACHE_LINE_SIZE) {
+        _mm_prefetch(bytes + offset, _MM_HINT_T0);
+    }
+}
+
+// Sets every array to zero, for any width
+template <size_t num_arrays>
+struct SIMD_zero_kernel {
+    template <typename vec_t>
+    void operator()(vec_t** arrays, size_t index) const {
+        for (size_t i = 0; i < num_arrays; ++i) {
+            arrays[i][index] = vec_t(0.0f);
+        }
+    }
+};
+
+// Stencil kernels that take a SIMD_window of any width, dispatched the same way
+template <typename kernel_t, int radius, typename = void>
+struct is_width_generic_stencil : std::false_type {};
+
+template <typename kernel_t, int radius>
+struct is_width_generic_stencil<kernel_t, radius, typename SIMD_void<
+    decltype(std::declval<const kernel_t&>()(std::declval<const SIMD_window<SIMD_128::SIMD_vecf, radius>&>())),
+    decltype(std::declval<const kernel_t&>()(std::declval<const SIMD_window<SIMD_256::SIMD_vecf, radius>&>())),
+    decltype(std::declval<const kernel_t&>()(std::declval<const SIMD_window<SIMD_512::SIMD_vecf, radius>&>()))>::type> : std::true_type {};
+
+
+/* Layouts for weaved_array: how its arrays share the one allocation.
+
+Both cut every array into tiles of tile_size elements and store tile t of every array before tile t + 1 of any. planar_layout makes the
+tile the whole array, so each array is one contiguous run, back to back with the next. A kernel reading k arrays then streams from k
+regions far apart, and with many arrays runs out of hardware prefetcher streams and TLB entries.
+
+tiled_layout<n> makes a tile n of the widest SIMD vectors (n * 64 bytes of floats), truly interleaving the arrays (AoSoA): everything a
+kernel touches for one index lies within num_arrays * n * 64 consecutive bytes. The engine moves every array's pointer on at each
+tile boundary, so tiles of a single vector cost the most when there are many arrays; benchmark_layouts() in main.cpp compares them.
+Scans and stencils walk one array end to end and take planar arrays only.
+*/
+struct planar_layout {
+    static const bool contiguous = true;
+
+    static size_t tile_size(size_t array_size) {
+        return array_size == 0 ? SIMD_MAX_VECTOR_SIZE : (array_size + SIMD_MAX_VECTOR_SIZE - 1) / SIMD_MAX_VECTOR_SIZE * SIMD_MAX_VECTOR_SIZE;
+    }
+};
+
+template <size_t vectors_per_tile = 1>
+struct tiled_layout {
+    static_assert(vectors_per_tile > 0, "a tile holds at least one vector");
+
+    static const bool contiguous = false;
+
+    static size_t tile_size(size_t) {
+        return vectors_per_tile * SIMD_MAX_VECTOR_SIZE;
+    }
+};
+
+// array_size of a weaved_array whose size is only known at runtime and passed to its constructor
+const size_t dynamic_array_size = static_cast<size_t>(-1);
+
+// One contiguous array of a weaved_array, indexed without bounds checks outside debug builds
+template <typename T>
+class weaved_span {
+public:
+    weaved_span(T* elements, size_t count) : elements(elements), count(count) {}
+
+    T& operator[](size_t index) const {
+        assert(index < count);
+        return elements[index];
+    }
+
+    T* data() const { return elements; }
+    size_t size() const { return count; }
+    T* begin() const { return elements; }
+    T* end() const { return elements + count; }
+
+private:
+    T* elements;
+    size_t count;
+};
+
+
+/* num_arrays arrays of array_size elements each, sharing a single allocation from allocator_t arranged by layout_t.
+
+Every tile starts on a 64-byte boundary and holds a whole number of the widest SIMD vectors, so the engine can view a tile as a
+SIMD_vecf* of any backend directly. Kernels only ever see one tile at a time and index within it, which makes them work with any layout.
+The padding after the last element is never read or written; the engine handles the last, partial vector with masked loads and stores.
+
+With array_size = dynamic_array_size the size is a constructor argument instead. Everything that depends on it becomes a runtime value,
+where for a fixed size the same member functions return constants the compiler folds into the engine's loops.
+
+An array owns its allocation and can be moved but not copied. It can also adopt a buffer someone else owns, laid out as the array would
+lay out its own (requiredBytes() long and 64-byte aligned), which is then never freed by the array.
+
+get() and set() check their indices and throw std::out_of_range. operator() and getSpan() only assert, so in release builds (NDEBUG)
+they are plain address arithmetic.
+
+Usage:
+weaved_array<float, 3, dynamic_array_size> samples(count);   // count only known at runtime
+samples(0, i) = 1.0f;                                        // Unchecked
+weaved_span<float> first = samples.getSpan(0);               // first[i], first.size(), range-for
+weaved_array<float, 3, dynamic_array_size> adopted(buffer, count); // Views buffer, no copy
+*/
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t = planar_layout, typename allocator_t = aligned_allocator<>>
 class weaved_array {
 public:
+    static const bool is_dynamic = array_size == dynamic_array_size;
+
+    // A fixed size array, or an empty dynamic one to move another into
     weaved_array();
+    // An array of size elements. For a fixed size array size must be array_size
+    explicit weaved_array(size_t size);
+    // Views buffer as an array of size elements, without copying it or taking ownership
+    weaved_array(T* buffer, size_t size);
+
+    weaved_array(weaved_array&& other) noexcept;
+    weaved_array& operator=(weaved_array&& other) noexcept;
+    weaved_array(const weaved_array&) = delete;
+    weaved_array& operator=(const weaved_array&) = delete;
+
     ~weaved_array();
 
+    // Elements per array
+    size_t size() const { return is_dynamic ? elements : array_size; }
+
+    // Elements of one array stored contiguously: the whole array, padded, for planar_layout
+    size_t tileSize() const { return layout_t::tile_size(size()); }
+
+    // Tiles per array
+    size_t tileCount() const { return (size() + tileSize() - 1) / tileSize(); }
+
+    // Distance between the starts of consecutive tiles of one array, in elements. Consecutive arrays' tiles are tileSize() apart
+    size_t tileStride() const { return num_arrays * tileSize(); }
+
+    // Bytes an array of size elements takes, padding included
+    static size_t requiredBytes(size_t size);
+
+    // Array index as one contiguous run, for planar_layout
     T* getArray(size_t index) const;
+    // Tile tile_index of array array_index
+    T* getTile(size_t array_index, size_t tile_index) const;
+    // Where element element_index of array array_index is stored
+    T* getAddress(size_t array_index, size_t element_index) const;
+
     T get(size_t array_index, size_t element_index) const;
     void set(size_t array_index, size_t element_index, const T& value);
 
+    // Unchecked access. The indices are only asserted
+    T& operator()(size_t array_index, size_t element_index) const;
+    weaved_span<T> getSpan(size_t index) const;
+
 private:
+    void allocate(size_t size);
+    void release();
+
+    size_t elements;
     T* data;
-    T** arrays;
+    bool owned;
 };
 
-template <typename T, size_t num_arrays, size_t array_size>
-weaved_array<T, num_arrays, array_size>::weaved_array() {
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::weaved_array() : elements(0), data(nullptr), owned(false) {
+    if (!is_dynamic) {
+        allocate(array_size);
+    }
+}
+
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::weaved_array(size_t size) : elements(0), data(nullptr), owned(false) {
+    allocate(size);
+}
+
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::weaved_array(T* buffer, size_t size) : elements(size), data(buffer), owned(false) {
+    if (!is_dynamic && size != array_size) {
+        throw std::invalid_argument("Size doesn't match the array's fixed size");
+    }
+    if (reinterpret_cast<uintptr_t>(buffer) % 64 != 0) {
+        throw std::invalid_argument("An adopted buffer must be 64-byte aligned");
+    }
+}
+
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::weaved_array(weaved_array&& other) noexcept : elements(other.elements), data(other.data), owned(other.owned) {
+    other.elements = 0;
+    other.data = nullptr;
+    other.owned = false;
+}
+
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+weaved_array<T, num_arrays, array_size, layout_t, allocator_t>& weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::operator=(weaved_array&& other) noexcept {
+    if (this != &other) {
+        release();
+        elements = other.elements;
+        data = other.data;
+        owned = other.owned;
+        other.elements = 0;
+        other.data = nullptr;
+        other.owned = false;
+    }
+    return *this;
+}
+
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::~weaved_array() {
+    release();
+}
+
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::allocate(size_t size) {
+    static_assert(std::is_trivially_copyable<T>::value, "weaved_array elements are never constructed or destroyed");
+    static_assert(allocator_t::alignment >= 64, "tiles are viewed as vectors up to 64 bytes wide");
+    if (!is_dynamic && size != array_size) {
+        throw std::invalid_argument("Size doesn't match the array's fixed size");
+    }
+
     // Allocate a contiguous block of memory for all arrays interleaved
-    data = new T[num_arrays * array_size];
-    arrays = new T * [num_arrays];
+    data = static_cast<T*>(allocator_t::allocate(requiredBytes(size)));
+    elements = size;
+    owned = true;
+}
 
-    // Initialize the pointers in the arrays array
-    for (size_t i = 0; i < num_arrays; ++i) {
-        arrays[i] = data + i * array_size;
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::release() {
+    if (owned) {
+        allocator_t::deallocate(data, requiredBytes(elements));
     }
 }
 
-template <typename T, size_t num_arrays, size_t array_size>
-weaved_array<T, num_arrays, array_size>::~weaved_array() {
-    delete[] data;
-    delete[] arrays;
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+size_t weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::requiredBytes(size_t size) {
+    size_t tile = layout_t::tile_size(size);
+    return (size + tile - 1) / tile * num_arrays * tile * sizeof(T);
 }
 
-template <typename T, size_t num_arrays, size_t array_size>
-T* weaved_array<T, num_arrays, array_size>::getArray(size_t index) const {
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+T* weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::getArray(size_t index) const {
+    static_assert(layout_t::contiguous, "getArray() needs planar_layout; use getTile() or getAddress() for tiled arrays");
     if (index >= num_arrays) {
         throw std::out_of_range("Array index out of range");
     }
-    return arrays[index];
+    return data + index * tileSize();
 }
 
-template <typename T, size_t num_arrays, size_t array_size>
-T weaved_array<T, num_arrays, array_size>::get(size_t array_index, size_t element_index) const {
-    if (array_index >= num_arrays || element_index >= array_size) {
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+T* weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::getTile(size_t array_index, size_t tile_index) const {
+    if (array_index >= num_arrays || tile_index >= tileCount()) {
         throw std::out_of_range("Index out of range");
     }
-    return arrays[array_index][element_index];
+    return data + tile_index * tileStride() + array_index * tileSize();
 }
 
-template <typename T, size_t num_arrays, size_t array_size>
-void weaved_array<T, num_arrays, array_size>::set(size_t array_index, size_t element_index, const T& value) {
-    if (array_index >= num_arrays || element_index >= array_size) {
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+T* weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::getAddress(size_t array_index, size_t element_index) const {
+    if (array_index >= num_arrays || element_index >= size()) {
         throw std::out_of_range("Index out of range");
     }
-    arrays[array_index][element_index] = value;
+    return &(*this)(array_index, element_index);
+}
+
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+T weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::get(size_t array_index, size_t element_index) const {
+    return *getAddress(array_index, element_index);
+}
+
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::set(size_t array_index, size_t element_index, const T& value) {
+    *getAddress(array_index, element_index) = value;
+}
+
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+T& weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::operator()(size_t array_index, size_t element_index) const {
+    assert(array_index < num_arrays && element_index < size());
+    size_t tile = tileSize();
+    return data[element_index / tile * tileStride() + array_index * tile + element_index % tile];
+}
+
+template <typename T, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+weaved_span<T> weaved_array<T, num_arrays, array_size, layout_t, allocator_t>::getSpan(size_t index) const {
+    static_assert(layout_t::contiguous, "getSpan() needs planar_layout");
+    assert(index < num_arrays);
+    return weaved_span<T>(data + index * tileSize(), size());
+}
+
+
+/* Long-lived pool of worker threads that SIMD operations are dispatched to.
+
+Spawning and joining std::threads costs tens of microseconds per launch, which dominates when many kernels are launched back to back
+on mid-sized arrays. The engine creates its workers once and parks them between launches. A launch bumps a generation counter; workers
+spin on it briefly (back-to-back launches usually arrive within microseconds) and only then fall asleep on a condition variable.
+
+The calling thread takes part in every launch as worker 0, so an engine with N threads only owns N - 1 std::threads.
+
+Element-wise launches go through parallel_for, which gives every worker an equal range of vectors up front. Workers process their own
+range in chunks that shrink as it empties, and once it is gone they steal the back half of another worker's range. A thread that gets
+descheduled, or a kernel whose cost depends on the data, no longer leaves the other cores idle at the end of a launch.
+
+With worker_placement::numa the engine pins every worker to one CPU, spreading them over the nodes in order so each node gets a run of
+consecutive workers, and a worker only steals from workers on its own node. Since a worker's starting range only depends on its index,
+a given part of an array is processed on the same node launch after launch. first_touch() zeroes fresh arrays through that same
+partitioning, which puts every page on the node that will process it; the allocator must not have prefaulted them. The calling
+thread is pinned to worker 0's CPU for the length of each launch and gets its own affinity back afterwards.
+
+Usage:
+compute_engine engine;                                  // One thread per hardware thread
+engine.call_SIMD_operation(inputs, pythagorean_theorum); // Blocks until every worker is done
+
+compute_engine numa_engine(compute_engine::default_thread_count(), worker_placement::numa);
+numa_engine.first_touch(arrays);                         // Before anything else writes arrays
+*/
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+class SIMD_graph;
+
+// Which CPUs the engine's workers run on
+enum class worker_placement {
+    any,  // Wherever the OS schedules them
+    numa  // Pinned, node by node, with stealing kept within a node
+};
+
+class compute_engine {
+public:
+    explicit compute_engine(size_t num_threads = default_thread_count(), worker_placement placement = worker_placement::any);
+    ~compute_engine();
+
+    compute_engine(const compute_engine&) = delete;
+    compute_engine& operator=(const compute_engine&) = delete;
+
+    // Applies simd_op to every vector of arrays. Idle workers steal from busy ones, so a slow thread doesn't hold up the launch.
+    // With SIMD_store_mode::streaming (or automatic, on large arrays) every array is written back with non-temporal stores. The kernel
+    // has already read each line it writes, so this saves no memory traffic and a non-temporal store to a cached line is slow on
+    // current Intel cores; it only keeps the launch from evicting everything else in the cache. Streaming pays off on outputs that are
+    // written without being read, as with call_SIMD_expression
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    void call_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, SIMD_operation simd_op, const SIMD_launch_options& options = SIMD_launch_options());
+
+    // Same, for a lambda or functor. The kernel is a template parameter here, so it is inlined and unrolled with the loop around it.
+    // Kernels written for any width (see is_width_generic_kernel) run on the widest backend the CPU supports, SIMD_backend_in_use()
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t, typename = typename std::enable_if<is_SIMD_kernel_object<operation_t>::value>::type>
+    void call_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options = SIMD_launch_options());
+
+    // call_SIMD_operation, queued on the engine's launch thread (see SIMD_async.h). Returns at once; arrays must outlive the launch and
+    // are only the caller's again once the future is ready. The kernel is copied
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+    SIMD_future call_SIMD_operation_async(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, operation_t simd_op, const SIMD_launch_options& options = SIMD_launch_options());
+
+    // arrays[output] = expression, where arg<k>() in the expression reads arrays[k]. Evaluated in one pass, one vector at a time.
+    // Streaming stores write arrays[output] without reading it into the cache first, unless the expression reads it itself. A
+    // prefetch_distance only applies to the arrays the expression reads, and to arrays[output] when it is stored through the cache
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename expression_t>
+    void call_SIMD_expression(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t output, const SIMD_expression<expression_t>& expression, const SIMD_launch_options& options = SIMD_launch_options());
+
+    // arrays[outputs...] = kernel(arrays[inputs]...) for every vector, with kernel taking the input vectors by value and returning the
+    // output ones (see SIMD_transform.h). Outputs are never read, so SIMD_store_mode::automatic streams them once they are large,
+    // unless one of them is also an input, and only inputs are prefetched. Kernels written for any width run on the widest backend the
+    // CPU supports
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, size_t... inputs, size_t... outputs, typename kernel_t>
+    void call_SIMD_transform(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, SIMD_inputs<inputs...> input_list, SIMD_outputs<outputs...> output_list, const kernel_t& kernel, const SIMD_launch_options& options = SIMD_launch_options(SIMD_store_mode::automatic));
+
+    // Runs every stage of pipeline over arrays in order, as call_SIMD_operation would one stage after another, but a block of
+    // pipeline.block_bytes at a time (see SIMD_pipeline.h), so later stages read the block from L2 rather than memory. options.unroll
+    // applies to every stage and the prefetch distance to the first; the store mode is ignored, since each stage's results are read
+    // again by the next. Pipelines whose stages are all written for any width run on the widest backend the CPU supports
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+    void call_SIMD_pipeline(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, const SIMD_launch_options& options = SIMD_launch_options());
+
+    // Runs every launch of graph, with the same results as running them in the order they were added (see SIMD_graph.h). Element-wise
+    // launches that don't wait on a whole-array one are fused into a single blocked pass, graph.block_bytes at a time
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    void call_SIMD_graph(const SIMD_graph<num_arrays, array_size, layout_t, allocator_t>& graph);
+
+    // Runs map(arrays, index) on every vector and folds what it returns with reduction, one of SIMD_reductions or a type like them
+    // (see SIMD_reduce.h). Maps written for any width are dispatched like kernels
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename map_t, typename reduction_t>
+    typename reduction_t::result_type call_SIMD_reduce(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const map_t& map, reduction_t reduction);
+
+    // Sum, smallest and largest element of arrays[array]. NaNs are skipped by min, max, argmin and argmax
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    float reduce_sum(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array);
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    float reduce_min(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array);
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    float reduce_max(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array);
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    SIMD_arg_result reduce_argmin(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array);
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    SIMD_arg_result reduce_argmax(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array);
+
+    // Dot product of arrays[first] and arrays[second]
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    float reduce_dot(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t first, size_t second);
+
+    // Euclidean (L2) norm of arrays[array]. The sum of squares is a float, so it overflows for elements above about 1e19
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    float reduce_norm(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array);
+
+    // arrays[output] = the inclusive or exclusive scan of arrays[input] under op, one of SIMD_scans (see SIMD_scan.h). input and
+    // output may be the same array. Runs on the widest backend the CPU supports
+    template <size_t num_arrays, size_t array_size, typename allocator_t, typename op_t>
+    void call_SIMD_scan(const weaved_array<float, num_arrays, array_size, planar_layout, allocator_t>& arrays, size_t input, size_t output, op_t op, SIMD_scan_mode mode = SIMD_scan_mode::inclusive);
+
+    // arrays[output] = kernel(window) for every vector, where the SIMD_window reads arrays[input] up to radius elements either side
+    // (see SIMD_stencil.h). Elements outside the array read as boundary. input and output must be different arrays
+    template <int radius, size_t num_arrays, size_t array_size, typename allocator_t, typename kernel_t>
+    void call_SIMD_stencil(const weaved_array<float, num_arrays, array_size, planar_layout, allocator_t>& arrays, size_t input, size_t output, const kernel_t& kernel, float boundary = 0.0f);
+
+    // arrays[array][i] = value
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    void fill_constant(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, float value, SIMD_store_mode mode = SIMD_store_mode::automatic);
+
+    // arrays[array][i] = start + i * step
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    void fill_ramp(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, float start, float step, SIMD_store_mode mode = SIMD_store_mode::automatic);
+
+    // arrays[array][i] = source[i]. source holds arrays.size() floats and needs no alignment
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    void fill_copy(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const float* source, SIMD_store_mode mode = SIMD_store_mode::automatic);
+
+    // Sets every vector of arrays[array] with generator(value, first_element) (see SIMD_fill.h). Generators written for any width run
+    // on the widest backend the CPU supports
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename generator_t>
+    void fill_generate(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const generator_t& generator, SIMD_store_mode mode = SIMD_store_mode::automatic);
+
+    // Zeroes every array from the workers that launches over arrays give each part of it to. With worker_placement::numa, call this
+    // on freshly allocated arrays and every page ends up on the node that processes it
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    void first_touch(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays);
+
+    // Queues launch(engine) on the engine's launch thread, after the asynchronous launches already queued, and returns at once.
+    // launch makes any of the engine's blocking launches, like call_SIMD_graph, asynchronous
+    template <typename launch_t>
+    SIMD_future run_async(launch_t launch);
+
+    // Calls task(worker_index, thread_count) once on every worker and returns once all of them are done
+    template <typename task_t>
+    void run_on_workers(task_t&& task);
+
+    // Calls body(begin, end) on disjoint subranges covering [0, num_vectors) and returns once all of them are done.
+    // Subranges are never shorter than grain vectors unless the whole range is.
+    template <typename body_t>
+    void parallel_for(size_t num_vectors, body_t&& body, size_t grain = default_grain);
+
+    size_t thread_count() const { return num_threads; }
+
+    // Nodes the workers are spread over, 1 unless the placement is numa
+    size_t node_count() const { return num_nodes; }
+
+    // Node of the worker with this index, in [0, node_count())
+    size_t worker_node(size_t worker_index) const { return worker_nodes[worker_index]; }
+
+    // std::thread::hardware_concurrency(), or 1 if the platform can't tell
+    static size_t default_thread_count();
+
+    // Engine shared by the free call_SIMD_operation()
+    static compute_engine& shared();
+
+    // Smallest subrange handed out or stolen by parallel_for, in vectors
+    static const size_t default_grain = 32;
+
+private:
+    friend class SIMD_future;
+
+    typedef void (*task_thunk)(void*, size_t, size_t);
+
+    // Test-and-test-and-set lock; ranges are only held for a handful of instructions
+    struct spin_lock {
+        std::atomic<bool> locked;
+
+        spin_lock() : locked(false) {}
+        void lock() {
+            while (locked.exchange(true, std::memory_order_acquire)) {
+                while (locked.load(std::memory_order_relaxed)) {
+                    _mm_pause();
+                }
+            }
+        }
+        void unlock() { locked.store(false, std::memory_order_release); }
+    };
+
+    // The vectors a worker still has to process. The owner takes chunks off the front, thieves take the back half.
+    // Padded to a cache line so workers polling their own range don't invalidate each other's.
+    struct work_range {
+        spin_lock lock;
+        size_t begin;
+        size_t end;
+        char padding[64 - sizeof(spin_lock) - 2 * sizeof(size_t)];
+
+        work_range() : begin(0), end(0) {}
+    };
+
+    // Runs simd_op over arrays in place, through the cache or streamed as options ask
+    template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+    void run_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options);
+
+    // The cached launch, with options.unroll vectors per iteration. With fence set every worker fences its stores before finishing,
+    // for kernels that stream their results themselves. prefetched, if given, picks the arrays options.prefetch_distance applies to
+    template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+    void run_SIMD_unrolled(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options, bool fence, const bool* prefetched = nullptr);
+
+    template <typename vec_t, size_t unroll, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+    void run_SIMD_chunks(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, size_t prefetch_distance, bool fence, const bool* prefetched);
+
+    // The streaming launch, with every array written back through non-temporal stores
+    template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+    void run_SIMD_stream(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, size_t prefetch_distance);
+
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+    void dispatch_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options, std::false_type);
+
+    template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename inputs_t, typename outputs_t, typename kernel_t>
+    void run_SIMD_transform(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, inputs_t input_list, outputs_t output_list, const kernel_t& kernel, const SIMD_launch_options& options, bool stream);
+
+    template <typename vec_t, size_t unroll, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename inputs_t, typename outputs_t, typename kernel_t>
+    void run_SIMD_transform_chunks(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, inputs_t input_list, outputs_t output_list, const kernel_t& kernel, size_t prefetch_distance, bool stream);
+
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename inputs_t, typename outputs_t, typename kernel_t>
+    void dispatch_SIMD_transform(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, inputs_t input_list, outputs_t output_list, const kernel_t& kernel, const SIMD_launch_options& options, bool stream, std::false_type);
+
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename inputs_t, typename outputs_t, typename kernel_t>
+    void dispatch_SIMD_transform(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, inputs_t input_list, outputs_t output_list, const kernel_t& kernel, const SIMD_launch_options& options, bool stream, std::true_type);
+
+    template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+    void run_SIMD_pipeline(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, const SIMD_launch_options& options);
+
+    template <typename vec_t, size_t unroll, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+    void run_SIMD_pipeline_blocks(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, size_t prefetch_distance);
+
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+    void dispatch_SIMD_pipeline(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, const SIMD_launch_options& options, std::false_type);
+
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+    void dispatch_SIMD_pipeline(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, const SIMD_launch_options& options, std::true_type);
+
+    // Runs the element-wise nodes of a graph over the arrays a block at a time, every node over a block before the next block
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+    void run_SIMD_graph_pass(const SIMD_graph<num_arrays, array_size, layout_t, allocator_t>& graph, const std::vector<size_t>& nodes);
+
+    template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename map_t, typename reduction_t>
+    typename reduction_t::result_type run_SIMD_reduce(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const map_t& map);
+
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename map_t, typename reduction_t>
+    typename reduction_t::result_type dispatch_SIMD_reduce(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const map_t& map, reduction_t, std::false_type);
+
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename map_t, typename reduction_t>
+    typename reduction_t::result_type dispatch_SIMD_reduce(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const map_t& map, reduction_t, std::true_type);
+
+    template <typename vec_t, typename op_t>
+    void run_SIMD_scan(const float* input, float* output, size_t array_size, SIMD_scan_mode mode);
+
+    template <typename vec_t, int radius, typename kernel_t>
+    void run_SIMD_stencil(const float* input, float* output, size_t array_size, const kernel_t& kernel, float boundary);
+
+    template <int radius, typename kernel_t>
+    void dispatch_SIMD_stencil(const float* input, float* output, size_t array_size, const kernel_t& kernel, float boundary, std::false_type);
+
+    template <int radius, typename kernel_t>
+    void dispatch_SIMD_stencil(const float* input, float* output, size_t array_size, const kernel_t& kernel, float boundary, std::true_type);
+
+    template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename producer_t>
+    void run_fill(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const producer_t& produce, bool stream);
+
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename producer_t>
+    void dispatch_fill(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const producer_t& produce, SIMD_store_mode mode, std::false_type);
+
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename producer_t>
+    void dispatch_fill(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const producer_t& produce, SIMD_store_mode mode, std::true_type);
+
+    template <size_t num_arrays>
+    static void check_array_index(size_t index);
+
+    // Whether a launch writing bytes bytes in mode uses non-temporal stores
+    static bool streams(SIMD_store_mode mode, size_t bytes);
+
+    static void check_launch_options(const SIMD_launch_options& options);
+
+    template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+    void dispatch_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options, std::true_type);
+
+    // Takes the next chunk of worker_index's own range into [begin, end). Chunks shrink as the range does so the tail stays stealable.
+    bool take_chunk(size_t worker_index, size_t workers, size_t grain, size_t& begin, size_t& end);
+
+    // Moves the back half of another worker's range into worker_index's own range
+    bool steal_range(size_t worker_index, size_t workers, size_t grain);
+
+    void launch(task_thunk thunk, void* context);
+    void worker_loop(size_t worker_index);
+
+    // Queues a job that runs launch(*this) and then finishes state with whatever it threw
+    template <typename launch_t>
+    void queue_async(std::shared_ptr<SIMD_launch_state> state, launch_t launch);
+
+    // Adds job to the asynchronous queue, starting the launch thread on first use
+    void enqueue_async(std::function<void()> job);
+    void async_loop();
+
+    // How many times a parked thread polls before blocking on a condition variable
+    static const int spin_count = 4096;
+
+    size_t num_threads;
+    worker_placement placement;
+    size_t num_nodes;
+    std::vector<unsigned> worker_cpus;  // CPU each worker is pinned to, with worker_placement::numa
+    std::vector<size_t> worker_nodes;
+    int spin_limit; // spin_count, or 0 when there are more threads than cores and spinning would only steal time from the workers
+    std::vector<std::thread> workers;
+
+    std::mutex launch_lock; // Serializes launches coming from different threads
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::atomic<size_t> generation;
+    std::atomic<size_t> pending;
+    std::atomic<bool> stopping;
+
+    task_thunk job_thunk;
+    void* job_context;
+
+    std::unique_ptr<work_range[]> ranges;
+
+    // Asynchronous launches, run in order by async_thread
+    std::mutex async_lock;
+    std::condition_variable async_wake;
+    std::deque<std::function<void()>> async_jobs;
+    std::thread async_thread;
+    bool async_stopping;
+};
+
+inline compute_engine::compute_engine(size_t num_threads, worker_placement placement)
+    : num_threads(num_threads == 0 ? 1 : num_threads), placement(placement), num_nodes(1), worker_nodes(this->num_threads, 0), spin_limit(this->num_threads <= default_thread_count() ? spin_count : 0), generation(0), pending(0), stopping(false), job_thunk(nullptr), job_context(nullptr), ranges(new work_range[this->num_threads]), async_stopping(false) {
+    if (placement == worker_placement::numa) {
+        numa_topology topology = numa_topology::detect();
+        size_t cpu_count = topology.cpu_count();
+        if (cpu_count == 0) {
+            this->placement = worker_placement::any;
+        }
+        else {
+            // Worker i gets CPU i * cpu_count / num_threads of the CPUs listed node by node, so consecutive workers share a node
+            std::vector<std::pair<unsigned, size_t>> cpus;
+            for (size_t node = 0; node < topology.nodes.size(); ++node) {
+                for (unsigned cpu : topology.nodes[node]) {
+                    cpus.push_back(std::make_pair(cpu, node));
+                }
+            }
+            // Nodes are numbered among the ones that got a worker
+            worker_cpus.resize(this->num_threads);
+            for (size_t i = 0; i < this->num_threads; ++i) {
+                const std::pair<unsigned, size_t>& assigned = cpus[i * cpu_count / this->num_threads];
+                worker_cpus[i] = assigned.first;
+                if (i > 0 && assigned.second != cpus[(i - 1) * cpu_count / this->num_threads].second) {
+                    ++num_nodes;
+                }
+                worker_nodes[i] = num_nodes - 1;
+            }
+        }
+    }
+
+    // Throws here, before any worker starts, on a CPU no backend can run on
+    SIMD_backend_in_use();
+
+    workers.reserve(this->num_threads - 1);
+    for (size_t i = 1; i < this->num_threads; ++i) {
+        workers.emplace_back(&compute_engine::worker_loop, this, i);
+    }
+}
+
+inline compute_engine::~compute_engine() {
+    // Queued launches still run, and may queue continuations of their own, before the workers go
+    {
+        std::lock_guard<std::mutex> guard(async_lock);
+        async_stopping = true;
+    }
+    async_wake.notify_all();
+    if (async_thread.joinable()) {
+        async_thread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping.store(true, std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+inline size_t compute_engine::default_thread_count() {
+    size_t count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+inline compute_engine& compute_engine::shared() {
+    static compute_engine engine;
+    return engine;
+}
+
+inline void compute_engine::launch(task_thunk thunk, void* context) {
+    std::lock_guard<std::mutex> launch_guard(launch_lock);
+
+    scoped_thread_pin caller_pin;
+    if (placement == worker_placement::numa) {
+        caller_pin.pin(worker_cpus[0]);
+    }
+
+    if (num_threads == 1) {
+        thunk(context, 0, 1);
+        return;
+    }
+
+    job_thunk = thunk;
+    job_context = context;
+    pending.store(num_threads - 1, std::memory_order_relaxed);
+    {
+        // Publishing under the lock means a worker can't miss the notify between checking generation and going to sleep
+        std::lock_guard<std::mutex> guard(lock);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    thunk(context, 0, num_threads);
+
+    for (int spin = 0; spin < spin_limit && pending.load(std::memory_order_acquire) != 0; ++spin) {
+        _mm_pause();
+    }
+    if (pending.load(std::memory_order_acquire) != 0) {
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [this] { return pending.load(std::memory_order_acquire) == 0; });
+    }
+}
+
+inline void compute_engine::worker_loop(size_t worker_index) {
+    size_t seen = 0;
+    if (placement == worker_placement::numa) {
+        pin_thread(worker_cpus[worker_index]);
+    }
+
+    for (;;) {
+        size_t current = generation.load(std::memory_order_acquire);
+        for (int spin = 0; spin < spin_limit && current == seen; ++spin) {
+            _mm_pause();
+            current = generation.load(std::memory_order_acquire);
+        }
+        if (current == seen) {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&] { return generation.load(std::memory_order_acquire) != seen; });
+            current = generation.load(std::memory_order_acquire);
+        }
+        seen = current;
+
+        if (stopping.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        job_thunk(job_context, worker_index, num_threads);
+
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Taking the lock orders this notify after the launcher either saw pending == 0 or started waiting
+            { std::lock_guard<std::mutex> guard(lock); }
+            done.notify_one();
+        }
+    }
+}
+
+inline void compute_engine::enqueue_async(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> guard(async_lock);
+        if (!async_thread.joinable()) {
+            async_thread = std::thread(&compute_engine::async_loop, this);
+        }
+        async_jobs.push_back(std::move(job));
+    }
+    async_wake.notify_one();
+}
+
+inline void compute_engine::async_loop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> guard(async_lock);
+            async_wake.wait(guard, [this] { return async_stopping || !async_jobs.empty(); });
+            if (async_jobs.empty()) {
+                return;
+            }
+            job = std::move(async_jobs.front());
+            async_jobs.pop_front();
+        }
+        job();
+    }
+}
+
+template <typename launch_t>
+void compute_engine::queue_async(std::shared_ptr<SIMD_launch_state> state, launch_t launch) {
+    enqueue_async([this, state, launch]() mutable {
+        std::exception_ptr failure;
+        try {
+            launch(*this);
+        }
+        catch (...) {
+            failure = std::current_exception();
+        }
+        state->finish(failure);
+    });
+}
+
+template <typename launch_t>
+SIMD_future compute_engine::run_async(launch_t launch) {
+    std::shared_ptr<SIMD_launch_state> state = std::make_shared<SIMD_launch_state>();
+    queue_async(state, launch);
+    return SIMD_future(this, state);
+}
+
+template <typename launch_t>
+SIMD_future SIMD_future::then(launch_t launch) const {
+    check_state();
+    std::shared_ptr<SIMD_launch_state> previous = state;
+    std::shared_ptr<SIMD_launch_state> next = std::make_shared<SIMD_launch_state>();
+    compute_engine* target = engine;
+
+    // Runs on the thread that finishes this launch, or here if it already has
+    auto queue_next = [previous, next, target, launch] {
+        if (previous->failure()) {
+            next->finish(previous->failure());
+        }
+        else {
+            target->queue_async(next, launch);
+        }
+    };
+    if (!state->on_ready(queue_next)) {
+        queue_next();
+    }
+    return SIMD_future(engine, next);
+}
+
+template <typename task_t>
+void compute_engine::run_on_workers(task_t&& task) {
+    typedef typename std::remove_reference<task_t>::type task_type;
+    launch([](void* context, size_t worker_index, size_t workers) {
+        (*static_cast<task_type*>(context))(worker_index, workers);
+    }, const_cast<void*>(static_cast<const void*>(&task)));
+}
+
+inline bool compute_engine::take_chunk(size_t worker_index, size_t workers, size_t grain, size_t& begin, size_t& end) {
+    work_range& range = ranges[worker_index];
+    std::lock_guard<spin_lock> guard(range.lock);
+
+    size_t remaining = range.end - range.begin;
+    if (remaining == 0) {
+        return false;
+    }
+
+    size_t chunk = remaining / (2 * workers);
+    chunk = chunk < grain ? grain : chunk;
+    chunk = chunk > remaining ? remaining : chunk;
+
+    begin = range.begin;
+    end = range.begin + chunk;
+    range.begin = end;
+    return true;
+}
+
+inline bool compute_engine::steal_range(size_t worker_index, size_t workers, size_t grain) {
+    for (size_t offset = 1; offset < workers; ++offset) {
+        size_t victim_index = (worker_index + offset) % workers;
+        if (worker_nodes[victim_index] != worker_nodes[worker_index]) {
+            continue;
+        }
+
+        work_range& victim = ranges[victim_index];
+        size_t begin, end;
+        {
+            std::lock_guard<spin_lock> guard(victim.lock);
+            size_t remaining = victim.end - victim.begin;
+            if (remaining < 2 * grain) {
+                continue;
+            }
+            begin = victim.begin + remaining / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+
+        work_range& own = ranges[worker_index];
+        std::lock_guard<spin_lock> guard(own.lock);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+template <typename body_t>
+void compute_engine::parallel_for(size_t num_vectors, body_t&& body, size_t grain) {
+    grain = grain == 0 ? 1 : grain;
+
+    run_on_workers([&](size_t worker_index, size_t workers) {
+        {
+            // Ranges are always drained by the end of a launch, so a thief that gets here first just finds nothing to steal
+            work_range& own = ranges[worker_index];
+            std::lock_guard<spin_lock> guard(own.lock);
+            own.begin = num_vectors * worker_index / workers;
+            own.end = num_vectors * (worker_index + 1) / workers;
+        }
+
+        size_t begin, end;
+        do {
+            while (take_chunk(worker_index, workers, grain, begin, end)) {
+                body(begin, end);
+            }
+        } while (steal_range(worker_index, workers, grain));
+    });
+}
+
+// Runs simd_op over elements [start, end). start must be vector aligned; if end isn't, the last vector is loaded and stored masked.
+// operation_t is either SIMD_operation or a kernel object, which the compiler can then inline into the loop. The loop runs inside
+// vec_t::run_targeted, so it is compiled for vec_t's instruction set even when the rest of the binary isn't.
+// simd_op gets pointers to the current tile of every array and a vector index within it, moving the pointers on a tile at a time.
+// Vectors go to simd_op unroll at a time, and with a prefetch_distance every array k with prefetched[k] set, or every array when
+// prefetched is null, is prefetched that many elements ahead
+template <size_t num_arrays, size_t array_size, typename operation_t = SIMD_operation, typename vec_t = SIMD_vecf, typename layout_t = planar_layout, typename allocator_t = aligned_allocator<>, size_t unroll = 1>
+void simd_operation_thread_prefetching(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, size_t start, size_t end, size_t prefetch_distance, const bool* prefetched) {
+    const size_t tile_vectors = arrays.tileSize() / vec_t::width;
+    const size_t tile_step = arrays.tileStride() / vec_t::width;
+    const size_t prefetch_vectors = (prefetch_distance + vec_t::width - 1) / vec_t::width;
+
+    size_t leftovers = end % vec_t::width;
+    size_t cutoff = end - leftovers;
+    size_t first = start / vec_t::width;
+    size_t last = cutoff / vec_t::width;
+
+    vec_t* simd_arrays[num_arrays];
+    if (first < last) {
+        for (size_t i = 0; i < num_arrays; ++i) {
+            simd_arrays[i] = reinterpret_cast<vec_t*>(arrays.getTile(i, first / tile_vectors));
+        }
+    }
+
+    vec_t::run_targeted([&] {
+        size_t index = first % tile_vectors;
+        for (size_t i = first; i < last;) {
+            if (index == tile_vectors) {
+                for (size_t k = 0; k < num_arrays; ++k) {
+                    simd_arrays[k] += tile_step;
+                }
+                index = 0;
+            }
+
+            size_t stop = tile_vectors - index < last - i ? tile_vectors : index + (last - i);
+            i += stop - index;
+            for (; index + unroll <= stop; index += unroll) {
+                // Once per cache line, not per vector
+                if (prefetch_vectors > 0 && index * sizeof(vec_t) % SIMD_CACHE_LINE_SIZE < unroll * sizeof(vec_t)) {
+                    for (size_t k = 0; k < num_arrays; ++k) {
+                        if (prefetched == nullptr || prefetched[k]) {
+                            SIMD_prefetch(simd_arrays[k] + index + prefetch_vectors, unroll);
+                        }
+                    }
+                }
+                for (size_t u = 0; u < unroll; ++u) {
+                    simd_op(simd_arrays, index + u);
+                }
+            }
+            for (; index < stop; ++index) {
+                simd_op(simd_arrays, index);
+            }
+        }
+
+        // A tile is a whole number of vectors, so the partial one is never split between two
+        if (leftovers > 0) {
+            vec_t tail[num_arrays];
+            vec_t* tail_arrays[num_arrays];
+            for (size_t i = 0; i < num_arrays; ++i) {
+                tail[i] = vec_t::load_partial(arrays.getAddress(i, cutoff), leftovers);
+                tail_arrays[i] = &tail[i];
+            }
+
+            simd_op(tail_arrays, 0);
+
+            for (size_t i = 0; i < num_arrays; ++i) {
+                tail[i].store_partial(arrays.getAddress(i, cutoff), leftovers);
+            }
+        }
+    });
+}
+
+// simd_operation_thread_prefetching with every array prefetched, under the signature callers already hand to std::thread
+template <size_t num_arrays, size_t array_size, typename operation_t = SIMD_operation, typename vec_t = SIMD_vecf, typename layout_t = planar_layout, typename allocator_t = aligned_allocator<>, size_t unroll = 1>
+void simd_operation_thread(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, size_t start, size_t end, size_t prefetch_distance) {
+    simd_operation_thread_prefetching<num_arrays, array_size, operation_t, vec_t, layout_t, allocator_t, unroll>(arrays, simd_op, start, end, prefetch_distance, nullptr);
+}
+
+// simd_operation_thread writing its results with non-temporal stores. Each vector of every array is copied to a register, run through
+// simd_op there and streamed back. The stores are fenced before returning; the partial last vector is stored through the cache as usual
+template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+void simd_stream_thread(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, size_t start, size_t end, size_t prefetch_distance) {
+    const size_t tile_vectors = arrays.tileSize() / vec_t::width;
+    const size_t tile_step = arrays.tileStride() / vec_t::width;
+    const size_t prefetch_vectors = (prefetch_distance + vec_t::width - 1) / vec_t::width;
+
+    size_t leftovers = end % vec_t::width;
+    size_t cutoff = end - leftovers;
+    size_t first = start / vec_t::width;
+    size_t last = cutoff / vec_t::width;
+
+    vec_t* simd_arrays[num_arrays];
+    if (first < last) {
+        for (size_t i = 0; i < num_arrays; ++i) {
+            simd_arrays[i] = reinterpret_cast<vec_t*>(arrays.getTile(i, first / tile_vectors));
+        }
+    }
+
+    vec_t::run_targeted([&] {
+        vec_t staged[num_arrays];
+        vec_t* staged_arrays[num_arrays];
+        for (size_t i = 0; i < num_arrays; ++i) {
+            staged_arrays[i] = &staged[i];
+        }
+
+        size_t index = first % tile_vectors;
+        for (size_t i = first; i < last; ++i, ++index) {
+            if (index == tile_vectors) {
+                for (size_t k = 0; k < num_arrays; ++k) {
+                    simd_arrays[k] += tile_step;
+                }
+                index = 0;
+            }
+
+            if (prefetch_vectors > 0 && index * sizeof(vec_t) % SIMD_CACHE_LINE_SIZE == 0) {
+                for (size_t k = 0; k < num_arrays; ++k) {
+                    SIMD_prefetch(simd_arrays[k] + index + prefetch_vectors, 1);
+                }
+            }
+            for (size_t k = 0; k < num_arrays; ++k) {
+                staged[k] = simd_arrays[k][index];
+            }
+            simd_op(staged_arrays, 0);
+            for (size_t k = 0; k < num_arrays; ++k) {
+                staged[k].store_stream(reinterpret_cast<float*>(simd_arrays[k] + index));
+            }
+        }
+
+        if (leftovers > 0) {
+            vec_t tail[num_arrays];
+            vec_t* tail_arrays[num_arrays];
+            for (size_t i = 0; i < num_arrays; ++i) {
+                tail[i] = vec_t::load_partial(arrays.getAddress(i, cutoff), leftovers);
+                tail_arrays[i] = &tail[i];
+            }
+
+            simd_op(tail_arrays, 0);
+
+            for (size_t i = 0; i < num_arrays; ++i) {
+                tail[i].store_partial(arrays.getAddress(i, cutoff), leftovers);
+            }
+        }
+    });
+
+    _mm_sfence();
+}
+
+// Stores kernel(inputs...) into outputs for elements [start, end), with the same tile walk, unrolling and masked tail as
+// simd_operation_thread. Only the input arrays are loaded and prefetched. With stream set the full vectors are written with
+// non-temporal stores, fenced before returning
+template <typename vec_t, bool stream, size_t unroll, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, size_t... inputs, size_t... outputs, typename kernel_t>
+void simd_transform_thread(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, SIMD_inputs<inputs...>, SIMD_outputs<outputs...>, const kernel_t& kernel, size_t start, size_t end, size_t prefetch_distance) {
+    const size_t tile_vectors = arrays.tileSize() / vec_t::width;
+    const size_t tile_step = arrays.tileStride() / vec_t::width;
+    const size_t prefetch_vectors = (prefetch_distance + vec_t::width - 1) / vec_t::width;
+    const size_t output_arrays[] = { outputs... };
+
+    size_t leftovers = end % vec_t::width;
+    size_t cutoff = end - leftovers;
+    size_t first = start / vec_t::width;
+    size_t last = cutoff / vec_t::width;
+
+    vec_t* simd_arrays[num_arrays];
+    if (first < last) {
+        for (size_t i = 0; i < num_arrays; ++i) {
+            simd_arrays[i] = reinterpret_cast<vec_t*>(arrays.getTile(i, first / tile_vectors));
+        }
+    }
+
+    vec_t::run_targeted([&] {
+        auto transform = [&](size_t index) {
+            auto result = kernel(static_cast<const vec_t&>(simd_arrays[inputs][index])...);
+            static_assert(SIMD_result_count<decltype(result)>::value == sizeof...(outputs), "a transform kernel must return one vector per output array");
+
+            for (size_t k = 0; k < sizeof...(outputs); ++k) {
+                vec_t* destination = simd_arrays[output_arrays[k]] + index;
+                if (stream) {
+                    SIMD_result_at(result, k).store_stream(reinterpret_cast<float*>(destination));
+                }
+                else {
+                    *destination = SIMD_result_at(result, k);
+                }
+            }
+        };
+
+        size_t index = first % tile_vectors;
+        for (size_t i = first; i < last;) {
+            if (index == tile_vectors) {
+                for (size_t k = 0; k < num_arrays; ++k) {
+                    simd_arrays[k] += tile_step;
+                }
+                index = 0;
+            }
+
+            size_t stop = tile_vectors - index < last - i ? tile_vectors : index + (last - i);
+            i += stop - index;
+            for (; index + unroll <= stop; index += unroll) {
+                if (prefetch_vectors > 0 && index * sizeof(vec_t) % SIMD_CACHE_LINE_SIZE < unroll * sizeof(vec_t)) {
+                    int expand[] = { 0, (SIMD_prefetch(simd_arrays[inputs] + index + prefetch_vectors, unroll), 0)... };
+                    (void)expand;
+                }
+                for (size_t u = 0; u < unroll; ++u) {
+                    transform(index + u);
+                }
+            }
+            for (; index < stop; ++index) {
+                transform(index);
+            }
+        }
+
+        if (leftovers > 0) {
+            auto result = kernel(vec_t::load_partial(arrays.getAddress(inputs, cutoff), leftovers)...);
+            for (size_t k = 0; k < sizeof...(outputs); ++k) {
+                SIMD_result_at(result, k).store_partial(arrays.getAddress(output_arrays[k], cutoff), leftovers);
+            }
+        }
+    });
+
+    if (stream) {
+        _mm_sfence();
+    }
+}
+
+// Runs every stage of a pipeline over elements [start, end) with simd_operation_thread, one stage after another. Only the first stage
+// prefetches; the others find the range in cache
+template <typename vec_t, size_t unroll, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t, size_t... stage_indices>
+void simd_pipeline_block(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const std::tuple<stages_t...>& stages, std::index_sequence<stage_indices...>, size_t start, size_t end, size_t prefetch_distance) {
+    int expand[] = { 0, (simd_operation_thread<num_arrays, array_size, stages_t, vec_t, layout_t, allocator_t, unroll>(arrays, std::get<stage_indices>(stages), start, end, stage_indices == 0 ? prefetch_distance : 0), 0)... };
+    (void)expand;
+}
+
+// Launches over one weaved_array, with the arrays each reads and writes, run by compute_engine::call_SIMD_graph (see SIMD_graph.h).
+// Element-wise launches are compiled for the widest backend the CPU supports when they are written for any width, like the engine's
+// own launches, and for SIMD_vecf otherwise. The graph keeps a reference to arrays and copies of the kernels
+template <size_t num_arrays, size_t array_size, typename layout_t = planar_layout, typename allocator_t = aligned_allocator<>>
+class SIMD_graph {
+public:
+    typedef weaved_array<float, num_arrays, array_size, layout_t, allocator_t> array_type;
+
+    explicit SIMD_graph(const array_type& arrays) : arrays(arrays), block_bytes(0) {}
+
+    // A kernel as call_SIMD_operation takes it, which reads the arrays in reads and writes those in writes, at the same index only
+    template <typename operation_t>
+    void add_kernel(const std::vector<size_t>& reads, const std::vector<size_t>& writes, operation_t kernel) {
+        add_node(reads, writes, true);
+        ranges.push_back(kernel_range(kernel, is_width_generic_kernel<operation_t>()));
+        launches.push_back(nullptr);
+    }
+
+    // A kernel as call_SIMD_transform takes it, with its reads and writes given by the array lists. Outputs are stored through the cache
+    template <size_t... inputs, size_t... outputs, typename kernel_t>
+    void add_transform(SIMD_inputs<inputs...> input_list, SIMD_outputs<outputs...> output_list, kernel_t kernel) {
+        static_assert(sizeof...(outputs) > 0, "a transform needs at least one output array");
+        static_assert(SIMD_inputs<inputs...>::below(num_arrays) && SIMD_outputs<outputs...>::below(num_arrays), "array index out of range");
+        static_assert(SIMD_outputs<outputs...>::distinct(), "an array can only be written by one output");
+
+        add_node({ inputs... }, { outputs... }, true);
+        ranges.push_back(transform_range(input_list, output_list, kernel, is_width_generic_transform<kernel_t, SIMD_inputs<inputs...>>()));
+        launches.push_back(nullptr);
+    }
+
+    // Anything else that reads the arrays in reads and writes those in writes, called as launch(engine) once everything it depends on
+    // is done. Usually one of the engine's whole-array launches, like call_SIMD_stencil or call_SIMD_scan
+    template <typename launch_t>
+    void add_launch(const std::vector<size_t>& reads, const std::vector<size_t>& writes, launch_t launch) {
+        add_node(reads, writes, false);
+        ranges.push_back(nullptr);
+        launches.push_back(launch);
+    }
+
+    size_t size() const { return nodes.size(); }
+
+    const array_type& arrays;
+
+    // Bytes of all arrays together that a fused pass runs at once. 0 is half the L2 cache, SIMD_l2_cache_size() / 2
+    size_t block_bytes;
+
+private:
+    friend class compute_engine;
+
+    void add_node(const std::vector<size_t>& reads, const std::vector<size_t>& writes, bool element_wise) {
+        for (size_t array : reads) {
+            check_array(array);
+        }
+        for (size_t array : writes) {
+            check_array(array);
+        }
+
+        SIMD_graph_node node = { reads, writes, element_wise, std::vector<size_t>() };
+        for (size_t earlier = 0; earlier < nodes.size(); ++earlier) {
+            if (SIMD_nodes_conflict(nodes[earlier], node)) {
+                node.dependencies.push_back(earlier);
+            }
+        }
+        nodes.push_back(node);
+    }
+
+    static void check_array(size_t array) {
+        if (array >= num_arrays) {
+            throw std::out_of_range("Array index out of range");
+        }
+    }
+
+    template <typename vec_t, typename operation_t>
+    std::function<void(size_t, size_t)> kernel_range_of_width(const operation_t& kernel) const {
+        const array_type* target = &arrays;
+        return [target, kernel](size_t start, size_t end) {
+            simd_operation_thread<num_arrays, array_size, operation_t, vec_t, layout_t, allocator_t>(*target, kernel, start, end, 0);
+        };
+    }
+
+    template <typename operation_t>
+    std::function<void(size_t, size_t)> kernel_range(const operation_t& kernel, std::false_type) const {
+        return kernel_range_of_width<SIMD_vecf>(kernel);
+    }
+
+    template <typename operation_t>
+    std::function<void(size_t, size_t)> kernel_range(const operation_t& kernel, std::true_type) const {
+        switch (SIMD_backend_in_use()) {
+        case SIMD_backend::avx512:
+            return kernel_range_of_width<SIMD_512::SIMD_vecf>(kernel);
+        case SIMD_backend::avx2:
+            return kernel_range_of_width<SIMD_256::SIMD_vecf>(kernel);
+        default:
+            return kernel_range_of_width<SIMD_128::SIMD_vecf>(kernel);
+        }
+    }
+
+    template <typename vec_t, typename inputs_t, typename outputs_t, typename kernel_t>
+    std::function<void(size_t, size_t)> transform_range_of_width(inputs_t input_list, outputs_t output_list, const kernel_t& kernel) const {
+        const array_type* target = &arrays;
+        return [target, input_list, output_list, kernel](size_t start, size_t end) {
+            simd_transform_thread<vec_t, false, 1>(*target, input_list, output_list, kernel, start, end, 0);
+        };
+    }
+
+    template <typename inputs_t, typename outputs_t, typename kernel_t>
+    std::function<void(size_t, size_t)> transform_range(inputs_t input_list, outputs_t output_list, const kernel_t& kernel, std::false_type) const {
+        return transform_range_of_width<SIMD_vecf>(input_list, output_list, kernel);
+    }
+
+    template <typename inputs_t, typename outputs_t, typename kernel_t>
+    std::function<void(size_t, size_t)> transform_range(inputs_t input_list, outputs_t output_list, const kernel_t& kernel, std::true_type) const {
+        switch (SIMD_backend_in_use()) {
+        case SIMD_backend::avx512:
+            return transform_range_of_width<SIMD_512::SIMD_vecf>(input_list, output_list, kernel);
+        case SIMD_backend::avx2:
+            return transform_range_of_width<SIMD_256::SIMD_vecf>(input_list, output_list, kernel);
+        default:
+            return transform_range_of_width<SIMD_128::SIMD_vecf>(input_list, output_list, kernel);
+        }
+    }
+
+    std::vector<SIMD_graph_node> nodes;
+
+    // Per node: runs an element-wise node over elements [start, end), start being cache line aligned; empty for whole-array nodes
+    std::vector<std::function<void(size_t, size_t)>> ranges;
+
+    // Per node: runs a whole-array node on the engine; empty for element-wise nodes
+    std::vector<std::function<void(compute_engine&)>> launches;
+};
+
+// A graph over arrays, without spelling out its template arguments
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+SIMD_graph<num_arrays, array_size, layout_t, allocator_t> make_SIMD_graph(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays) {
+    return SIMD_graph<num_arrays, array_size, layout_t, allocator_t>(arrays);
+}
+
+// Vectors a reduction accumulates before folding its lanes. Keeps the argmin/argmax offsets, which are floats, exact
+#define SIMD_REDUCE_BLOCK_SIZE (1 << 20)
+
+// Folds map over elements [start, end) into one result, with the same masked tail as simd_operation_thread. The lanes past end get
+// the reduction's identity. Four accumulators take turns, so each vector's add or compare doesn't wait on the previous one's result
+template <typename vec_t, typename reduction_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename map_t>
+typename reduction_t::result_type simd_reduce_thread(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const map_t& map, size_t start, size_t end) {
+    typedef typename reduction_t::template accumulator<vec_t> accumulator_t;
+    const size_t tile_vectors = arrays.tileSize() / vec_t::width;
+    const size_t tile_step = arrays.tileStride() / vec_t::width;
+
+    size_t leftovers = end % vec_t::width;
+    size_t cutoff = end - leftovers;
+    typename reduction_t::result_type result = reduction_t::empty();
+
+    vec_t* first_tiles[num_arrays];
+    if (arrays.tileCount() > 0) {
+        for (size_t i = 0; i < num_arrays; ++i) {
+            first_tiles[i] = reinterpret_cast<vec_t*>(arrays.getTile(i, 0));
+        }
+    }
+
+    vec_t::run_targeted([&] {
+        vec_t* simd_arrays[num_arrays];
+        size_t last = cutoff / vec_t::width;
+        for (size_t block = start / vec_t::width; block < last; block += SIMD_REDUCE_BLOCK_SIZE) {
+            size_t block_end = last - block < SIMD_REDUCE_BLOCK_SIZE ? last : block + SIMD_REDUCE_BLOCK_SIZE;
+
+            accumulator_t accumulators[4];
+            size_t i = block;
+            while (i < block_end) {
+                // Offsets count vectors from the start of the block, whatever tile they are in
+                size_t tile = i / tile_vectors;
+                size_t tile_start = tile * tile_vectors;
+                size_t segment_end = block_end - tile_start < tile_vectors ? block_end : tile_start + tile_vectors;
+                for (size_t k = 0; k < num_arrays; ++k) {
+                    simd_arrays[k] = first_tiles[k] + tile * tile_step;
+                }
+
+                for (; i + 4 <= segment_end; i += 4) {
+                    accumulators[0].add(map(simd_arrays, i - tile_start), static_cast<float>(i - block));
+                    accumulators[1].add(map(simd_arrays, i + 1 - tile_start), static_cast<float>(i + 1 - block));
+                    accumulators[2].add(map(simd_arrays, i + 2 - tile_start), static_cast<float>(i + 2 - block));
+                    accumulators[3].add(map(simd_arrays, i + 3 - tile_start), static_cast<float>(i + 3 - block));
+                }
+                for (; i < segment_end; ++i) {
+                    accumulators[0].add(map(simd_arrays, i - tile_start), static_cast<float>(i - block));
+                }
+            }
+
+            accumulators[0].merge(accumulators[1]);
+            accumulators[2].merge(accumulators[3]);
+            accumulators[0].merge(accumulators[2]);
+            result = reduction_t::merge(result, accumulators[0].result(block));
+        }
+
+        if (leftovers > 0) {
+            vec_t tail[num_arrays];
+            vec_t* tail_arrays[num_arrays];
+            for (size_t i = 0; i < num_arrays; ++i) {
+                tail[i] = vec_t::load_partial(arrays.getAddress(i, cutoff), leftovers);
+                tail_arrays[i] = &tail[i];
+            }
+
+            accumulator_t accumulator;
+            accumulator.add(select(vec_t::mask_type::first(leftovers), map(tail_arrays, 0), accumulator_t::identity()), 0.0f);
+            result = reduction_t::merge(result, accumulator.result(cutoff / vec_t::width));
+        }
+    });
+    return result;
+}
+
+// Stores what produce gives for elements [start, end) of arrays[array], with non-temporal stores when stream is set. start must be
+// vector aligned; a partial last vector is stored masked, through the cache. Streamed stores are fenced before returning, so they are
+// visible to whoever waits for the launch
+template <typename vec_t, bool stream, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename producer_t>
+void simd_fill_thread(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const producer_t& produce, size_t start, size_t end) {
+    const size_t tile_vectors = arrays.tileSize() / vec_t::width;
+    const size_t tile_step = arrays.tileStride() / vec_t::width;
+
+    size_t leftovers = end % vec_t::width;
+    size_t cutoff = end - leftovers;
+    size_t first = start / vec_t::width;
+    size_t last = cutoff / vec_t::width;
+
+    vec_t* destination = first < last ? reinterpret_cast<vec_t*>(arrays.getTile(array, first / tile_vectors)) : nullptr;
+
+    vec_t::run_targeted([&] {
+        size_t index = first % tile_vectors;
+        for (size_t i = first; i < last; ++i, ++index) {
+            if (index == tile_vectors) {
+                destination += tile_step;
+                index = 0;
+            }
+
+            vec_t value;
+            produce(value, i * vec_t::width);
+            if (stream) {
+                value.store_stream(reinterpret_cast<float*>(destination + index));
+            }
+            else {
+                destination[index] = value;
+            }
+        }
+
+        if (leftovers > 0) {
+            vec_t value;
+            produce(value, cutoff);
+            value.store_partial(arrays.getAddress(array, cutoff), leftovers);
+        }
+    });
+
+    if (stream) {
+        _mm_sfence();
+    }
+}
+
+// Scans elements [start, end) of input into output, starting from op's identity, and returns the combination of all of them: the carry
+// for the elements after end. start must be vector aligned; a partial last vector is loaded and stored masked
+template <typename vec_t, typename op_t, bool exclusive>
+float simd_scan_thread(const float* input, float* output, size_t start, size_t end) {
+    size_t leftovers = end % vec_t::width;
+    size_t cutoff = end - leftovers;
+    float total = op_t::identity();
+
+    vec_t::run_targeted([&] {
+        const vec_t* source = reinterpret_cast<const vec_t*>(input);
+        vec_t* destination = reinterpret_cast<vec_t*>(output);
+        vec_t carry(op_t::identity());
+
+        // Exclusive scans are the inclusive scan one lane up, with the carry coming in at lane 0
+        auto scan = [&](const vec_t& value) {
+            vec_t scanned = op_t::combine(carry, SIMD_lane_scan<op_t, vec_t>::apply(SIMD_scan_input<op_t, vec_t>::prepare(value)));
+            vec_t result = exclusive ? select(vec_t::mask_type::first(1), carry, scanned.template shift_up<1>()) : scanned;
+            carry = scanned.template broadcast<vec_t::width - 1>();
+            return result;
+        };
+
+        for (size_t i = start / vec_t::width; i < cutoff / vec_t::width; ++i) {
+            destination[i] = scan(source[i]);
+        }
+        if (leftovers > 0) {
+            scan(vec_t::load_partial(input + cutoff, leftovers)).store_partial(output + cutoff, leftovers);
+        }
+        total = carry.template extract<0>();
+    });
+    return total;
+}
+
+// Combines carry into elements [start, end) of output, the second pass of a scan. Same alignment rules as simd_scan_thread
+template <typename vec_t, typename op_t>
+void simd_scan_carry_thread(float* output, size_t start, size_t end, float carry) {
+    size_t leftovers = end % vec_t::width;
+    size_t cutoff = end - leftovers;
+
+    vec_t::run_targeted([&] {
+        vec_t* destination = reinterpret_cast<vec_t*>(output);
+        vec_t carried(carry);
+        for (size_t i = start / vec_t::width; i < cutoff / vec_t::width; ++i) {
+            destination[i] = op_t::combine(carried, destination[i]);
+        }
+        if (leftovers > 0) {
+            op_t::combine(carried, vec_t::load_partial(output + cutoff, leftovers)).store_partial(output + cutoff, leftovers);
+        }
+    });
+}
+
+// Runs a stencil kernel for output vectors [begin, end). Vectors whose whole neighbourhood is inside the array read input directly; the
+// ones within radius of either end copy their neighbourhood into a buffer padded with boundary first. The last vector is stored masked
+template <typename vec_t, int radius, typename kernel_t>
+void simd_stencil_thread(const float* input, float* output, size_t array_size, const kernel_t& kernel, float boundary, size_t begin, size_t end) {
+    typedef SIMD_window<vec_t, radius> window_t;
+    const size_t width = vec_t::width;
+    size_t interior_begin = (radius + width - 1) / width;
+    size_t interior_end = array_size >= radius + width ? (array_size - radius) / width : 0;
+
+    vec_t::run_targeted([&] {
+        vec_t* destination = reinterpret_cast<vec_t*>(output);
+
+        auto edge = [&](size_t i) {
+            float staged[width + 2 * radius];
+            for (size_t k = 0; k < width + 2 * radius; ++k) {
+                size_t element = i * width + k - radius; // Wraps around below zero, which the comparison also rejects
+                staged[k] = element < array_size ? input[element] : boundary;
+            }
+
+            vec_t result = kernel(window_t(staged + radius));
+            size_t remaining = array_size - i * width;
+            if (remaining >= width) {
+                destination[i] = result;
+            }
+            else {
+                result.store_partial(output + i * width, remaining);
+            }
+        };
+
+        size_t i = begin;
+        for (; i < end && i < interior_begin; ++i) {
+            edge(i);
+        }
+        for (; i < end && i < interior_end; ++i) {
+            destination[i] = kernel(window_t(input + i * width));
+        }
+        for (; i < end; ++i) {
+            edge(i);
+        }
+    });
+}
+
+template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+void compute_engine::run_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options) {
+    if (streams(options.store_mode, num_arrays * arrays.size() * sizeof(float))) {
+        run_SIMD_stream<vec_t>(arrays, simd_op, options.prefetch_distance);
+    }
+    else {
+        run_SIMD_unrolled<vec_t>(arrays, simd_op, options, false);
+    }
+}
+
+template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+void compute_engine::run_SIMD_unrolled(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options, bool fence, const bool* prefetched) {
+    switch (options.unroll) {
+    case 8:
+        run_SIMD_chunks<vec_t, 8>(arrays, simd_op, options.prefetch_distance, fence, prefetched);
+        break;
+    case 4:
+        run_SIMD_chunks<vec_t, 4>(arrays, simd_op, options.prefetch_distance, fence, prefetched);
+        break;
+    case 2:
+        run_SIMD_chunks<vec_t, 2>(arrays, simd_op, options.prefetch_distance, fence, prefetched);
+        break;
+    default:
+        run_SIMD_chunks<vec_t, 1>(arrays, simd_op, options.prefetch_distance, fence, prefetched);
+        break;
+    }
+}
+
+template <typename vec_t, size_t unroll, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+void compute_engine::run_SIMD_chunks(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, size_t prefetch_distance, bool fence, const bool* prefetched) {
+    size_t size = arrays.size();
+    size_t num_vectors = (size + vec_t::width - 1) / vec_t::width;
+
+    // Whoever gets the last vector also gets the partial one at the end
+    parallel_for(num_vectors, [&](size_t begin, size_t end) {
+        size_t last = end * vec_t::width;
+        simd_operation_thread_prefetching<num_arrays, array_size, operation_t, vec_t, layout_t, allocator_t, unroll>(arrays, simd_op, begin * vec_t::width, last < size ? last : size, prefetch_distance, prefetched);
+        if (fence) {
+            _mm_sfence();
+        }
+    });
+}
+
+template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+void compute_engine::run_SIMD_stream(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, size_t prefetch_distance) {
+    size_t size = arrays.size();
+    size_t num_vectors = (size + vec_t::width - 1) / vec_t::width;
+
+    parallel_for(num_vectors, [&](size_t begin, size_t end) {
+        size_t last = end * vec_t::width;
+        simd_stream_thread<vec_t>(arrays, simd_op, begin * vec_t::width, last < size ? last : size, prefetch_distance);
+    });
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+void compute_engine::dispatch_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options, std::false_type) {
+    run_SIMD_operation<SIMD_vecf>(arrays, simd_op, options);
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+void compute_engine::dispatch_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options, std::true_type) {
+    switch (SIMD_backend_in_use()) {
+    case SIMD_backend::avx512:
+        run_SIMD_operation<SIMD_512::SIMD_vecf>(arrays, simd_op, options);
+        break;
+    case SIMD_backend::avx2:
+        run_SIMD_operation<SIMD_256::SIMD_vecf>(arrays, simd_op, options);
+        break;
+    default:
+        run_SIMD_operation<SIMD_128::SIMD_vecf>(arrays, simd_op, options);
+        break;
+    }
+}
+
+template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename inputs_t, typename outputs_t, typename kernel_t>
+void compute_engine::run_SIMD_transform(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, inputs_t input_list, outputs_t output_list, const kernel_t& kernel, const SIMD_launch_options& options, bool stream) {
+    switch (options.unroll) {
+    case 8:
+        run_SIMD_transform_chunks<vec_t, 8>(arrays, input_list, output_list, kernel, options.prefetch_distance, stream);
+        break;
+    case 4:
+        run_SIMD_transform_chunks<vec_t, 4>(arrays, input_list, output_list, kernel, options.prefetch_distance, stream);
+        break;
+    case 2:
+        run_SIMD_transform_chunks<vec_t, 2>(arrays, input_list, output_list, kernel, options.prefetch_distance, stream);
+        break;
+    default:
+        run_SIMD_transform_chunks<vec_t, 1>(arrays, input_list, output_list, kernel, options.prefetch_distance, stream);
+        break;
+    }
+}
+
+template <typename vec_t, size_t unroll, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename inputs_t, typename outputs_t, typename kernel_t>
+void compute_engine::run_SIMD_transform_chunks(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, inputs_t input_list, outputs_t output_list, const kernel_t& kernel, size_t prefetch_distance, bool stream) {
+    size_t size = arrays.size();
+    size_t num_vectors = (size + vec_t::width - 1) / vec_t::width;
+
+    parallel_for(num_vectors, [&](size_t begin, size_t end) {
+        size_t last = end * vec_t::width;
+        last = last < size ? last : size;
+        if (stream) {
+            simd_transform_thread<vec_t, true, unroll>(arrays, input_list, output_list, kernel, begin * vec_t::width, last, prefetch_distance);
+        }
+        else {
+            simd_transform_thread<vec_t, false, unroll>(arrays, input_list, output_list, kernel, begin * vec_t::width, last, prefetch_distance);
+        }
+    });
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename inputs_t, typename outputs_t, typename kernel_t>
+void compute_engine::dispatch_SIMD_transform(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, inputs_t input_list, outputs_t output_list, const kernel_t& kernel, const SIMD_launch_options& options, bool stream, std::false_type) {
+    run_SIMD_transform<SIMD_vecf>(arrays, input_list, output_list, kernel, options, stream);
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename inputs_t, typename outputs_t, typename kernel_t>
+void compute_engine::dispatch_SIMD_transform(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, inputs_t input_list, outputs_t output_list, const kernel_t& kernel, const SIMD_launch_options& options, bool stream, std::true_type) {
+    switch (SIMD_backend_in_use()) {
+    case SIMD_backend::avx512:
+        run_SIMD_transform<SIMD_512::SIMD_vecf>(arrays, input_list, output_list, kernel, options, stream);
+        break;
+    case SIMD_backend::avx2:
+        run_SIMD_transform<SIMD_256::SIMD_vecf>(arrays, input_list, output_list, kernel, options, stream);
+        break;
+    default:
+        run_SIMD_transform<SIMD_128::SIMD_vecf>(arrays, input_list, output_list, kernel, options, stream);
+        break;
+    }
+}
+
+template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+void compute_engine::run_SIMD_pipeline(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, const SIMD_launch_options& options) {
+    switch (options.unroll) {
+    case 8:
+        run_SIMD_pipeline_blocks<vec_t, 8>(arrays, pipeline, options.prefetch_distance);
+        break;
+    case 4:
+        run_SIMD_pipeline_blocks<vec_t, 4>(arrays, pipeline, options.prefetch_distance);
+        break;
+    case 2:
+        run_SIMD_pipeline_blocks<vec_t, 2>(arrays, pipeline, options.prefetch_distance);
+        break;
+    default:
+        run_SIMD_pipeline_blocks<vec_t, 1>(arrays, pipeline, options.prefetch_distance);
+        break;
+    }
+}
+
+template <typename vec_t, size_t unroll, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+void compute_engine::run_SIMD_pipeline_blocks(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, size_t prefetch_distance) {
+    size_t size = arrays.size();
+    size_t num_vectors = (size + vec_t::width - 1) / vec_t::width;
+    size_t block_bytes = pipeline.block_bytes > 0 ? pipeline.block_bytes : SIMD_l2_cache_size() / 2;
+    size_t block_vectors = block_bytes / (num_arrays * sizeof(vec_t));
+    block_vectors = block_vectors > 0 ? block_vectors : 1;
+
+    // Chunks are cut into blocks here rather than by parallel_for, so small arrays still spread over every worker
+    parallel_for(num_vectors, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; block += block_vectors) {
+            size_t block_end = end - block < block_vectors ? end : block + block_vectors;
+            size_t last = block_end * vec_t::width;
+            simd_pipeline_block<vec_t, unroll>(arrays, pipeline.stages, std::index_sequence_for<stages_t...>(), block * vec_t::width, last < size ? last : size, prefetch_distance);
+        }
+    });
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+void compute_engine::dispatch_SIMD_pipeline(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, const SIMD_launch_options& options, std::false_type) {
+    run_SIMD_pipeline<SIMD_vecf>(arrays, pipeline, options);
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+void compute_engine::dispatch_SIMD_pipeline(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, const SIMD_launch_options& options, std::true_type) {
+    switch (SIMD_backend_in_use()) {
+    case SIMD_backend::avx512:
+        run_SIMD_pipeline<SIMD_512::SIMD_vecf>(arrays, pipeline, options);
+        break;
+    case SIMD_backend::avx2:
+        run_SIMD_pipeline<SIMD_256::SIMD_vecf>(arrays, pipeline, options);
+        break;
+    default:
+        run_SIMD_pipeline<SIMD_128::SIMD_vecf>(arrays, pipeline, options);
+        break;
+    }
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void compute_engine::run_SIMD_graph_pass(const SIMD_graph<num_arrays, array_size, layout_t, allocator_t>& graph, const std::vector<size_t>& nodes) {
+    // Blocks are whole cache lines, so they start on a vector of every width and each node can run at its own
+    const size_t line_elements = SIMD_CACHE_LINE_SIZE / sizeof(float);
+    size_t size = graph.arrays.size();
+    size_t num_lines = (size + line_elements - 1) / line_elements;
+    size_t block_bytes = graph.block_bytes > 0 ? graph.block_bytes : SIMD_l2_cache_size() / 2;
+    size_t block_lines = block_bytes / (num_arrays * SIMD_CACHE_LINE_SIZE);
+    block_lines = block_lines > 0 ? block_lines : 1;
+
+    parallel_for(num_lines, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; block += block_lines) {
+            size_t block_end = end - block < block_lines ? end : block + block_lines;
+            size_t last = block_end * line_elements;
+            for (size_t node : nodes) {
+                graph.ranges[node](block * line_elements, last < size ? last : size);
+            }
+        }
+    });
+}
+
+template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename map_t, typename reduction_t>
+typename reduction_t::result_type compute_engine::run_SIMD_reduce(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const map_t& map) {
+    size_t size = arrays.size();
+    size_t num_vectors = (size + vec_t::width - 1) / vec_t::width;
+    typename reduction_t::result_type result = reduction_t::empty();
+    spin_lock result_lock;
+
+    // Chunks finish in any order, so the merge order isn't the element order. That only matters to merges that aren't associative
+    parallel_for(num_vectors, [&](size_t begin, size_t end) {
+        size_t last = end * vec_t::width;
+        typename reduction_t::result_type partial = simd_reduce_thread<vec_t, reduction_t>(arrays, map, begin * vec_t::width, last < size ? last : size);
+
+        std::lock_guard<spin_lock> guard(result_lock);
+        result = reduction_t::merge(result, partial);
+    });
+    return result;
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename map_t, typename reduction_t>
+typename reduction_t::result_type compute_engine::dispatch_SIMD_reduce(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const map_t& map, reduction_t, std::false_type) {
+    return run_SIMD_reduce<SIMD_vecf, num_arrays, array_size, layout_t, allocator_t, map_t, reduction_t>(arrays, map);
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename map_t, typename reduction_t>
+typename reduction_t::result_type compute_engine::dispatch_SIMD_reduce(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const map_t& map, reduction_t, std::true_type) {
+    switch (SIMD_backend_in_use()) {
+    case SIMD_backend::avx512:
+        return run_SIMD_reduce<SIMD_512::SIMD_vecf, num_arrays, array_size, layout_t, allocator_t, map_t, reduction_t>(arrays, map);
+    case SIMD_backend::avx2:
+        return run_SIMD_reduce<SIMD_256::SIMD_vecf, num_arrays, array_size, layout_t, allocator_t, map_t, reduction_t>(arrays, map);
+    default:
+        return run_SIMD_reduce<SIMD_128::SIMD_vecf, num_arrays, array_size, layout_t, allocator_t, map_t, reduction_t>(arrays, map);
+    }
+}
+
+template <typename vec_t, typename op_t>
+void compute_engine::run_SIMD_scan(const float* input, float* output, size_t array_size, SIMD_scan_mode mode) {
+    size_t num_vectors = (array_size + vec_t::width - 1) / vec_t::width;
+    if (num_vectors == 0) {
+        return;
+    }
+
+    // Every block but the first is written twice, so a single thread scans the array as one block. Otherwise a few blocks per thread
+    // let parallel_for balance the load; the carries are combined serially, so there shouldn't be many more
+    size_t blocks = num_threads == 1 ? 1 : num_threads * 4;
+    blocks = blocks > num_vectors ? num_vectors : blocks;
+    auto block_start = [&](size_t block) {
+        size_t element = num_vectors * block / blocks * vec_t::width;
+        return element < array_size ? element : array_size;
+    };
+
+    std::vector<float> carries(blocks);
+    parallel_for(blocks, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; ++block) {
+            carries[block] = mode == SIMD_scan_mode::exclusive
+                ? simd_scan_thread<vec_t, op_t, true>(input, output, block_start(block), block_start(block + 1))
+                : simd_scan_thread<vec_t, op_t, false>(input, output, block_start(block), block_start(block + 1));
+        }
+    }, 1);
+
+    // Each block's carry is the combination of every block before it
+    float running = op_t::identity();
+    for (size_t block = 0; block < blocks; ++block) {
+        float total = carries[block];
+        carries[block] = running;
+        running = op_t::combine(running, total);
+    }
+
+    parallel_for(blocks - 1, [&](size_t begin, size_t end) {
+        for (size_t block = begin + 1; block < end + 1; ++block) {
+            simd_scan_carry_thread<vec_t, op_t>(output, block_start(block), block_start(block + 1), carries[block]);
+        }
+    }, 1);
+}
+
+template <size_t num_arrays, size_t array_size, typename allocator_t, typename op_t>
+void compute_engine::call_SIMD_scan(const weaved_array<float, num_arrays, array_size, planar_layout, allocator_t>& arrays, size_t input, size_t output, op_t, SIMD_scan_mode mode) {
+    check_array_index<num_arrays>(input);
+    check_array_index<num_arrays>(output);
+    const float* source = arrays.getArray(input);
+    float* destination = arrays.getArray(output);
+
+    switch (SIMD_backend_in_use()) {
+    case SIMD_backend::avx512:
+        run_SIMD_scan<SIMD_512::SIMD_vecf, op_t>(source, destination, arrays.size(), mode);
+        break;
+    case SIMD_backend::avx2:
+        run_SIMD_scan<SIMD_256::SIMD_vecf, op_t>(source, destination, arrays.size(), mode);
+        break;
+    default:
+        run_SIMD_scan<SIMD_128::SIMD_vecf, op_t>(source, destination, arrays.size(), mode);
+        break;
+    }
+}
+
+template <typename vec_t, int radius, typename kernel_t>
+void compute_engine::run_SIMD_stencil(const float* input, float* output, size_t array_size, const kernel_t& kernel, float boundary) {
+    size_t num_vectors = (array_size + vec_t::width - 1) / vec_t::width;
+    parallel_for(num_vectors, [&](size_t begin, size_t end) {
+        simd_stencil_thread<vec_t, radius>(input, output, array_size, kernel, boundary, begin, end);
+    });
+}
+
+template <int radius, typename kernel_t>
+void compute_engine::dispatch_SIMD_stencil(const float* input, float* output, size_t array_size, const kernel_t& kernel, float boundary, std::false_type) {
+    run_SIMD_stencil<SIMD_vecf, radius>(input, output, array_size, kernel, boundary);
+}
+
+template <int radius, typename kernel_t>
+void compute_engine::dispatch_SIMD_stencil(const float* input, float* output, size_t array_size, const kernel_t& kernel, float boundary, std::true_type) {
+    switch (SIMD_backend_in_use()) {
+    case SIMD_backend::avx512:
+        run_SIMD_stencil<SIMD_512::SIMD_vecf, radius>(input, output, array_size, kernel, boundary);
+        break;
+    case SIMD_backend::avx2:
+        run_SIMD_stencil<SIMD_256::SIMD_vecf, radius>(input, output, array_size, kernel, boundary);
+        break;
+    default:
+        run_SIMD_stencil<SIMD_128::SIMD_vecf, radius>(input, output, array_size, kernel, boundary);
+        break;
+    }
+}
+
+template <int radius, size_t num_arrays, size_t array_size, typename allocator_t, typename kernel_t>
+void compute_engine::call_SIMD_stencil(const weaved_array<float, num_arrays, array_size, planar_layout, allocator_t>& arrays, size_t input, size_t output, const kernel_t& kernel, float boundary) {
+    check_array_index<num_arrays>(input);
+    check_array_index<num_arrays>(output);
+    if (input == output) {
+        throw std::invalid_argument("A stencil can't write the array it reads");
+    }
+    const float* source = arrays.getArray(input);
+    float* destination = arrays.getArray(output);
+
+    dispatch_SIMD_stencil<radius>(source, destination, arrays.size(), kernel, boundary, is_width_generic_stencil<kernel_t, radius>());
+}
+
+template <typename vec_t, size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename producer_t>
+void compute_engine::run_fill(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const producer_t& produce, bool stream) {
+    size_t size = arrays.size();
+    size_t num_vectors = (size + vec_t::width - 1) / vec_t::width;
+
+    parallel_for(num_vectors, [&](size_t begin, size_t end) {
+        size_t last = end * vec_t::width;
+        last = last < size ? last : size;
+        if (stream) {
+            simd_fill_thread<vec_t, true>(arrays, array, produce, begin * vec_t::width, last);
+        }
+        else {
+            simd_fill_thread<vec_t, false>(arrays, array, produce, begin * vec_t::width, last);
+        }
+    });
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename producer_t>
+void compute_engine::dispatch_fill(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const producer_t& produce, SIMD_store_mode mode, std::false_type) {
+    check_array_index<num_arrays>(array);
+    run_fill<SIMD_vecf>(arrays, array, produce, streams(mode, arrays.size() * sizeof(float)));
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename producer_t>
+void compute_engine::dispatch_fill(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const producer_t& produce, SIMD_store_mode mode, std::true_type) {
+    check_array_index<num_arrays>(array);
+    bool stream = streams(mode, arrays.size() * sizeof(float));
+    switch (SIMD_backend_in_use()) {
+    case SIMD_backend::avx512:
+        run_fill<SIMD_512::SIMD_vecf>(arrays, array, produce, stream);
+        break;
+    case SIMD_backend::avx2:
+        run_fill<SIMD_256::SIMD_vecf>(arrays, array, produce, stream);
+        break;
+    default:
+        run_fill<SIMD_128::SIMD_vecf>(arrays, array, produce, stream);
+        break;
+    }
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void compute_engine::fill_constant(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, float value, SIMD_store_mode mode) {
+    dispatch_fill(arrays, array, SIMD_fills::constant{ value }, mode, std::true_type());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void compute_engine::fill_ramp(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, float start, float step, SIMD_store_mode mode) {
+    dispatch_fill(arrays, array, SIMD_fills::ramp{ start, step }, mode, std::true_type());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void compute_engine::fill_copy(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const float* source, SIMD_store_mode mode) {
+    dispatch_fill(arrays, array, SIMD_fills::copy{ source, arrays.size() }, mode, std::true_type());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename generator_t>
+void compute_engine::fill_generate(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const generator_t& generator, SIMD_store_mode mode) {
+    dispatch_fill(arrays, array, generator, mode, is_width_generic_producer<generator_t>());
+}
+
+inline void compute_engine::check_launch_options(const SIMD_launch_options& options) {
+    if (options.unroll != 1 && options.unroll != 2 && options.unroll != 4 && options.unroll != 8) {
+        throw std::invalid_argument("Unroll must be 1, 2, 4 or 8");
+    }
+}
+
+inline bool compute_engine::streams(SIMD_store_mode mode, size_t bytes) {
+    return mode == SIMD_store_mode::streaming || (mode == SIMD_store_mode::automatic && bytes >= SIMD_STREAM_MIN_BYTES);
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void compute_engine::first_touch(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays) {
+    call_SIMD_operation(arrays, SIMD_zero_kernel<num_arrays>());
+}
+
+template <size_t num_arrays>
+void compute_engine::check_array_index(size_t index) {
+    if (index >= num_arrays) {
+        throw std::out_of_range("Array index out of range");
+    }
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename map_t, typename reduction_t>
+typename reduction_t::result_type compute_engine::call_SIMD_reduce(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const map_t& map, reduction_t reduction) {
+    return dispatch_SIMD_reduce(arrays, map, reduction, is_width_generic_kernel<map_t>());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+float compute_engine::reduce_sum(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    check_array_index<num_arrays>(array);
+    return call_SIMD_reduce(arrays, SIMD_element_map{ array }, SIMD_reductions::sum());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+float compute_engine::reduce_min(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    check_array_index<num_arrays>(array);
+    return call_SIMD_reduce(arrays, SIMD_element_map{ array }, SIMD_reductions::min());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+float compute_engine::reduce_max(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    check_array_index<num_arrays>(array);
+    return call_SIMD_reduce(arrays, SIMD_element_map{ array }, SIMD_reductions::max());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+SIMD_arg_result compute_engine::reduce_argmin(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    check_array_index<num_arrays>(array);
+    return call_SIMD_reduce(arrays, SIMD_element_map{ array }, SIMD_reductions::argmin());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+SIMD_arg_result compute_engine::reduce_argmax(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    check_array_index<num_arrays>(array);
+    return call_SIMD_reduce(arrays, SIMD_element_map{ array }, SIMD_reductions::argmax());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+float compute_engine::reduce_dot(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t first, size_t second) {
+    check_array_index<num_arrays>(first);
+    check_array_index<num_arrays>(second);
+    return call_SIMD_reduce(arrays, SIMD_product_map{ first, second }, SIMD_reductions::sum());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+float compute_engine::reduce_norm(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    return std::sqrt(reduce_dot(arrays, array, array));
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void compute_engine::call_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, SIMD_operation simd_op, const SIMD_launch_options& options) {
+    check_launch_options(options);
+    run_SIMD_operation<SIMD_vecf>(arrays, simd_op, options);
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t, typename>
+void compute_engine::call_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options) {
+    check_launch_options(options);
+    dispatch_SIMD_operation(arrays, simd_op, options, is_width_generic_kernel<operation_t>());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+SIMD_future compute_engine::call_SIMD_operation_async(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, operation_t simd_op, const SIMD_launch_options& options) {
+    const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>* target = &arrays;
+    return run_async([target, simd_op, options](compute_engine& engine) {
+        engine.call_SIMD_operation(*target, simd_op, options);
+    });
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, size_t... inputs, size_t... outputs, typename kernel_t>
+void compute_engine::call_SIMD_transform(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, SIMD_inputs<inputs...> input_list, SIMD_outputs<outputs...> output_list, const kernel_t& kernel, const SIMD_launch_options& options) {
+    static_assert(sizeof...(outputs) > 0, "a transform needs at least one output array");
+    static_assert(SIMD_inputs<inputs...>::below(num_arrays) && SIMD_outputs<outputs...>::below(num_arrays), "array index out of range");
+    static_assert(SIMD_outputs<outputs...>::distinct(), "an array can only be written by one output");
+
+    // Streaming an output that was just loaded as an input saves nothing, see call_SIMD_operation
+    bool overlaps = false;
+    for (size_t output : { outputs... }) {
+        overlaps = overlaps || SIMD_inputs<inputs...>::contains(output);
+    }
+    bool stream = options.store_mode == SIMD_store_mode::streaming || (!overlaps && streams(options.store_mode, sizeof...(outputs) * arrays.size() * sizeof(float)));
+
+    check_launch_options(options);
+    dispatch_SIMD_transform(arrays, input_list, output_list, kernel, options, stream, is_width_generic_transform<kernel_t, SIMD_inputs<inputs...>>());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+void compute_engine::call_SIMD_pipeline(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, const SIMD_launch_options& options) {
+    check_launch_options(options);
+    dispatch_SIMD_pipeline(arrays, pipeline, options, is_width_generic_pipeline<stages_t...>());
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void compute_engine::call_SIMD_graph(const SIMD_graph<num_arrays, array_size, layout_t, allocator_t>& graph) {
+    for (const SIMD_graph_step& step : SIMD_schedule_graph(graph.nodes)) {
+        if (step.fused) {
+            run_SIMD_graph_pass(graph, step.nodes);
+        }
+        else {
+            graph.launches[step.nodes[0]](*this);
+        }
+    }
+}
+
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename expression_t>
+void compute_engine::call_SIMD_expression(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t output, const SIMD_expression<expression_t>& expression, const SIMD_launch_options& options) {
+    if (output >= num_arrays) {
+        throw std::out_of_range("Array index out of range");
+    }
+    check_launch_options(options);
+
+    // Only arrays the expression reads are prefetched, plus arrays[output] when its stores go through the cache
+    bool prefetched[num_arrays];
+    for (size_t k = 0; k < num_arrays; ++k) {
+        prefetched[k] = expression_t::reads(k);
+    }
+
+    const expression_t& tree = expression.self();
+    if (!streams(options.store_mode, arrays.size() * sizeof(float))) {
+        prefetched[output] = true;
+        run_SIMD_unrolled<SIMD_vecf>(arrays, [&tree, output](SIMD_vecf** simd_arrays, size_t index) {
+            simd_arrays[output][index] = tree.evaluate(simd_arrays, index);
+        }, options, false, prefetched);
+        return;
+    }
+
+    // The result goes straight from the register to memory. Only the partial last vector, staged on the stack, is stored normally
+    run_SIMD_unrolled<SIMD_vecf>(arrays, [&tree, output](SIMD_vecf** simd_arrays, size_t index) {
+        tree.evaluate(simd_arrays, index).store_stream(reinterpret_cast<float*>(simd_arrays[output] + index));
+    }, options, true, prefetched);
+}
+
+// Runs simd_op over arrays on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void call_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, SIMD_operation simd_op, const SIMD_launch_options& options = SIMD_launch_options()) {
+    compute_engine::shared().call_SIMD_operation(arrays, simd_op, options);
+}
+
+// Runs a lambda or functor kernel over arrays on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t, typename = typename std::enable_if<is_SIMD_kernel_object<operation_t>::value>::type>
+void call_SIMD_operation(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const operation_t& simd_op, const SIMD_launch_options& options = SIMD_launch_options()) {
+    compute_engine::shared().call_SIMD_operation<num_arrays, array_size>(arrays, simd_op, options);
+}
+
+// Queues simd_op over arrays on the shared engine's launch thread
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename operation_t>
+SIMD_future call_SIMD_operation_async(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, operation_t simd_op, const SIMD_launch_options& options = SIMD_launch_options()) {
+    return compute_engine::shared().call_SIMD_operation_async(arrays, simd_op, options);
+}
+
+// Evaluates expression into arrays[output] on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename expression_t>
+void call_SIMD_expression(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t output, const SIMD_expression<expression_t>& expression, const SIMD_launch_options& options = SIMD_launch_options()) {
+    compute_engine::shared().call_SIMD_expression(arrays, output, expression, options);
+}
+
+// Runs an out-of-place kernel over arrays on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, size_t... inputs, size_t... outputs, typename kernel_t>
+void call_SIMD_transform(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, SIMD_inputs<inputs...> input_list, SIMD_outputs<outputs...> output_list, const kernel_t& kernel, const SIMD_launch_options& options = SIMD_launch_options(SIMD_store_mode::automatic)) {
+    compute_engine::shared().call_SIMD_transform(arrays, input_list, output_list, kernel, options);
+}
+
+// Runs every stage of pipeline over arrays, a block at a time, on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename... stages_t>
+void call_SIMD_pipeline(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const SIMD_pipeline<stages_t...>& pipeline, const SIMD_launch_options& options = SIMD_launch_options()) {
+    compute_engine::shared().call_SIMD_pipeline(arrays, pipeline, options);
+}
+
+// Runs every launch of graph on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void call_SIMD_graph(const SIMD_graph<num_arrays, array_size, layout_t, allocator_t>& graph) {
+    compute_engine::shared().call_SIMD_graph(graph);
+}
+
+// Folds map over arrays with reduction on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename map_t, typename reduction_t>
+typename reduction_t::result_type call_SIMD_reduce(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, const map_t& map, reduction_t reduction) {
+    return compute_engine::shared().call_SIMD_reduce(arrays, map, reduction);
+}
+
+// Sum of arrays[array] on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+float reduce_sum(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    return compute_engine::shared().reduce_sum(arrays, array);
+}
+
+// Smallest element of arrays[array] on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+float reduce_min(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    return compute_engine::shared().reduce_min(arrays, array);
+}
+
+// Largest element of arrays[array] on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+float reduce_max(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    return compute_engine::shared().reduce_max(arrays, array);
+}
+
+// Smallest element of arrays[array] and its index on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+SIMD_arg_result reduce_argmin(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    return compute_engine::shared().reduce_argmin(arrays, array);
+}
+
+// Largest element of arrays[array] and its index on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+SIMD_arg_result reduce_argmax(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    return compute_engine::shared().reduce_argmax(arrays, array);
+}
+
+// Dot product of arrays[first] and arrays[second] on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+float reduce_dot(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t first, size_t second) {
+    return compute_engine::shared().reduce_dot(arrays, first, second);
+}
+
+// L2 norm of arrays[array] on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+float reduce_norm(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array) {
+    return compute_engine::shared().reduce_norm(arrays, array);
+}
+
+// Scans arrays[input] into arrays[output] with op on the shared engine
+template <size_t num_arrays, size_t array_size, typename allocator_t, typename op_t>
+void call_SIMD_scan(const weaved_array<float, num_arrays, array_size, planar_layout, allocator_t>& arrays, size_t input, size_t output, op_t op, SIMD_scan_mode mode = SIMD_scan_mode::inclusive) {
+    compute_engine::shared().call_SIMD_scan(arrays, input, output, op, mode);
+}
+
+// Runs a stencil from arrays[input] into arrays[output] on the shared engine
+template <int radius, size_t num_arrays, size_t array_size, typename allocator_t, typename kernel_t>
+void call_SIMD_stencil(const weaved_array<float, num_arrays, array_size, planar_layout, allocator_t>& arrays, size_t input, size_t output, const kernel_t& kernel, float boundary = 0.0f) {
+    compute_engine::shared().call_SIMD_stencil<radius>(arrays, input, output, kernel, boundary);
+}
+
+// arrays[array][i] = value on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void fill_constant(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, float value, SIMD_store_mode mode = SIMD_store_mode::automatic) {
+    compute_engine::shared().fill_constant(arrays, array, value, mode);
+}
+
+// arrays[array][i] = start + i * step on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void fill_ramp(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, float start, float step, SIMD_store_mode mode = SIMD_store_mode::automatic) {
+    compute_engine::shared().fill_ramp(arrays, array, start, step, mode);
+}
+
+// arrays[array][i] = source[i] on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t>
+void fill_copy(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const float* source, SIMD_store_mode mode = SIMD_store_mode::automatic) {
+    compute_engine::shared().fill_copy(arrays, array, source, mode);
+}
+
+// Fills arrays[array] from generator on the shared engine
+template <size_t num_arrays, size_t array_size, typename layout_t, typename allocator_t, typename generator_t>
+void fill_generate(const weaved_array<float, num_arrays, array_size, layout_t, allocator_t>& arrays, size_t array, const generator_t& generator, SIMD_store_mode mode = SIMD_store_mode::automatic) {
+    compute_engine::shared().fill_generate(arrays, array, generator, mode);
 }
@@ -30,9 +30,28 @@ Note: Allocation and population of test arrays not counted towards the benchmark
 SIMD_float_256.h: SIMD operation took 0.02106850 seconds.
 SIMD_float_128.h: SIMD operation took 0.05056010 seconds.
 
+Accuracy tiers (benchmark_accuracy_tiers(), Intel Xeon with AVX-512, 1 core), in millions of elements per second and max error:
+
+function  tier        AVX-512      AVX2       SSE    error
+exp       fast           3615      3303      1367    7.8e-05 relative
+exp       standard       2564      2325       800    2.3e-07 relative
+exp       precise        1699      1309       420    7.9e-08 relative
+log       fast           3957      3818       981    5.0e-05 relative
+log       standard       2931      2787       589    1.5e-07 relative
+log       precise        1276       776       244    7.3e-08 relative
+sin       fast           4079      3696      1051    1.1e-04 absolute
+sin       standard       3162      2969       727    1.3e-07 absolute
+sin       precise        1699      1382       393    7.6e-08 absolute
+pow       fast           1703      1334       392    2.0e-04 relative
+pow       standard       1215      1034       240    2.6e-06 relative
+pow       precise         341       230        71    8.7e-08 relative
+sqrt      fast           6021      4904      2962    5.9e-05 relative
+sqrt      standard       5066      4314      2161    6.2e-08 relative
+sqrt      precise        3306      3304      3288    5.9e-08 relative
+
 */
 
-#include "compute_engine.h"-
+#include "compute_engine.h"
 
 #include <iostream>
 #include <cmath>  // For std::log2
@@ -41,9 +60,16 @@ SIMD_float_128.h: SIMD operation took 0.05056010 seconds.
 #include <vector>
 #include <chrono>
 #include <cstring>
+#include <random>
+#include <algorithm>
 
 #define TEST_SIZE 1000 * 1000 * 8
-typedef void (*SIMD_operation)(SIMD_vecf**, size_t);
+#define LAUNCH_TEST_SIZE 1024 * 16
+#define LAUNCH_TEST_ITERATIONS 2000
+#define TIER_TEST_SIZE 1024 * 64
+#define TIER_TEST_ITERATIONS 100
+#define LAYOUT_TEST_ELEMENTS 1024 * 1024 * 16
+#define LAYOUT_TEST_ITERATIONS 10
 
 
 
@@ -58,6 +84,87 @@ void pythagorean_theorum(SIMD_vecf** arrays, size_t index)
     x += y;
     x.inline_sqrt();
 }
+
+// pythagorean_theorum for any SIMD_vecf width, so the engine can run it on the widest backend the CPU supports
+struct pythagorean_kernel {
+    template <typename vec_t>
+    void operator()(vec_t** arrays, size_t index) const
+    {
+        vec_t& x = arrays[0][index];
+        vec_t& y = arrays[1][index];
+
+        x.inline_pow(2);
+        y.inline_pow(2);
+        x += y;
+        x.inline_sqrt();
+    }
+};
+
+// The same, out of place: the hypotenuse is returned rather than written over x, and y is left alone
+struct hypotenuse_kernel {
+    template <typename vec_t>
+    vec_t operator()(const vec_t& x, const vec_t& y) const
+    {
+        return (x * x + y * y).sqrt();
+    }
+};
+
+// 5-point moving average, a stencil kernel for any SIMD_vecf width
+struct moving_average_kernel {
+    template <typename vec_t>
+    vec_t operator()(const SIMD_window<vec_t, 2>& in) const
+    {
+        return (in.at(-2) + in.at(-1) + in.at(0) + in.at(1) + in.at(2)) * vec_t(0.2f);
+    }
+};
+
+// arrays[0] = the sum of every array, for any SIMD_vecf width. Reads one vector of every array per index
+template <size_t num_arrays>
+struct sum_arrays_kernel {
+    template <typename vec_t>
+    void operator()(vec_t** arrays, size_t index) const
+    {
+        vec_t total = arrays[0][index];
+        for (size_t i = 1; i < num_arrays; i++) {
+            total += arrays[i][index];
+        }
+        arrays[0][index] = total;
+    }
+};
+
+// One math function at one accuracy tier, for any SIMD_vecf width. Reads arrays[0] (and arrays[1] for pow), writes arrays[2]
+template <typename accuracy_t>
+struct exp_kernel {
+    template <typename vec_t>
+    void operator()(vec_t** arrays, size_t index) const { arrays[2][index] = arrays[0][index].exp(accuracy_t()); }
+};
+template <typename accuracy_t>
+struct log_kernel {
+    template <typename vec_t>
+    void operator()(vec_t** arrays, size_t index) const { arrays[2][index] = arrays[0][index].log(accuracy_t()); }
+};
+template <typename accuracy_t>
+struct sin_kernel {
+    template <typename vec_t>
+    void operator()(vec_t** arrays, size_t index) const { arrays[2][index] = arrays[0][index].sin(accuracy_t()); }
+};
+template <typename accuracy_t>
+struct pow_kernel {
+    template <typename vec_t>
+    void operator()(vec_t** arrays, size_t index) const { arrays[2][index] = arrays[0][index].pow(arrays[1][index], accuracy_t()); }
+};
+template <typename accuracy_t>
+struct sqrt_kernel {
+    template <typename vec_t>
+    void operator()(vec_t** arrays, size_t index) const { arrays[2][index] = arrays[0][index].sqrt(accuracy_t()); }
+};
+
+double reference_exp(double x, double) { return std::exp(x); }
+double reference_log(double x, double) { return std::log(x); }
+double reference_sin(double x, double) { return std::sin(x); }
+double reference_pow(double x, double y) { return std::pow(x, y); }
+double reference_sqrt(double x, double) { return std::sqrt(x); }
+
 template <size_t num_elements>
 void print_float_array(float* array)
 {
@@ -68,20 +175,9 @@ void print_float_array(float* array)
     std::cout << array[num_elements - 1] << '\n';
 }
 
+// What call_SIMD_operation did before the engine kept a worker pool: four fresh std::threads per launch. Kept for the launch overhead benchmark
 template <size_t num_arrays, size_t array_size>
-void simd_operation_thread(const weaved_array<SIMD_vecf, num_arrays, array_size>& arrays, SIMD_operation simd_op, size_t start, size_t end) {
-    SIMD_vecf* simd_arrays[num_arrays];
-    for (size_t i = 0; i < num_arrays; ++i) {
-        simd_arrays[i] = reinterpret_cast<SIMD_vecf*>(arrays.getArray(i));
-    }
-
-    for (size_t i = start; i < end; i += SIMD_VECTOR_SIZE) {
-        simd_op(simd_arrays, i / SIMD_VECTOR_SIZE);
-    }
-}
-
-template <size_t num_arrays, size_t array_size>
-void call_SIMD_operation(const weaved_array<SIMD_vecf, num_arrays, array_size>& arrays, SIMD_operation simd_op) {
+void call_SIMD_operation_spawning(const weaved_array<float, num_arrays, array_size>& arrays, SIMD_operation simd_op) {
     size_t num_threads = 4;
     size_t chunk_size = (array_size / SIMD_VECTOR_SIZE) / num_threads * SIMD_VECTOR_SIZE;
     size_t leftovers = array_size % SIMD_VECTOR_SIZE;
@@ -91,33 +187,615 @@ void call_SIMD_operation(const weaved_array<SIMD_vecf, num_arrays, array_size>&
     for (size_t t = 0; t < num_threads; ++t) {
         size_t start = t * chunk_size;
         size_t end = (t == num_threads - 1) ? cutoff : (t + 1) * chunk_size;
-        threads.push_back(std::thread(simd_operation_thread<num_arrays, array_size>, std::cref(arrays), simd_op, start, end));
+        threads.push_back(std::thread(simd_operation_thread<num_arrays, array_size, SIMD_operation>, std::cref(arrays), simd_op, start, end, size_t(0)));
     }
 
     for (auto& thread : threads) {
         thread.join();
     }
-
-    if (leftovers > 0) {
-        // Handle leftovers as before
-    }
 }
 
 
-template <size_t num_arrays, size_t array_size>
-weaved_array<SIMD_vecf, num_arrays, array_size> gen_arrays() {
-    weaved_array<SIMD_vecf, num_arrays, array_size> arrays;
+template <size_t num_arrays, size_t array_size, typename layout_t = planar_layout>
+weaved_array<float, num_arrays, array_size, layout_t> gen_arrays() {
+    weaved_array<float, num_arrays, array_size, layout_t> arrays;
 
     for (size_t i = 0; i < num_arrays; i++) {
         for (size_t j = 0; j < array_size; j++) {
-            // Assuming SIMD_vecf can be initialized directly with float values
-            arrays.set(i, j, SIMD_vecf(static_cast<float>(j)));
+            arrays.set(i, j, static_cast<float>(j));
         }
     }
 
     return arrays;
 }
 
+// Many back-to-back launches on a small array, where thread creation used to dominate the actual work
+void benchmark_launch_overhead()
+{
+    auto inputs = gen_arrays<2, LAUNCH_TEST_SIZE>();
+    compute_engine engine;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < LAUNCH_TEST_ITERATIONS; i++) {
+        call_SIMD_operation_spawning<2, LAUNCH_TEST_SIZE>(inputs, pythagorean_theorum);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::micro> spawning = (end - start) / LAUNCH_TEST_ITERATIONS;
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < LAUNCH_TEST_ITERATIONS; i++) {
+        engine.call_SIMD_operation<2, LAUNCH_TEST_SIZE>(inputs, pythagorean_theorum);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::micro> pooled = (end - start) / LAUNCH_TEST_ITERATIONS;
+
+    std::cout << std::setprecision(2) << "Per-launch time, " << LAUNCH_TEST_SIZE << " elements:\n";
+    std::cout << "  spawning 4 std::threads: " << spawning.count() << " us\n";
+    std::cout << "  compute_engine (" << engine.thread_count() << " threads): " << pooled.count() << " us\n\n";
+}
+
+// The same kernel through the function pointer path and as a lambda the compiler can inline into simd_operation_thread
+void benchmark_kernel_dispatch()
+{
+    auto inputs = gen_arrays<2, TEST_SIZE>();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    call_SIMD_operation<2, TEST_SIZE>(inputs, pythagorean_theorum);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> pointer = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    call_SIMD_operation<2, TEST_SIZE>(inputs, [](SIMD_vecf** arrays, size_t index) { pythagorean_theorum(arrays, index); });
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> inlined = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    call_SIMD_operation<2, TEST_SIZE>(inputs, pythagorean_kernel());
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> dispatched = end - start;
+
+    std::cout << std::setprecision(8) << "pythagorean_theorum, " << TEST_SIZE << " elements:\n";
+    std::cout << "  function pointer: " << pointer.count() << " seconds\n";
+    std::cout << "  inlined lambda: " << inlined.count() << " seconds\n";
+    std::cout << "  dispatched to " << SIMD_backend_name(SIMD_backend_in_use()) << ": " << dispatched.count() << " seconds\n\n";
+}
+
+// x in [low, high] in arrays[0], uniformly or log-uniformly, and y in [-8, 8] in arrays[1]
+template <size_t array_size>
+void fill_tier_inputs(weaved_array<float, 3, array_size>& arrays, double low, double high, bool log_scale)
+{
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t j = 0; j < array_size; j++) {
+        double t = unit(random);
+        double x = log_scale ? low * std::pow(high / low, t) : low + (high - low) * t;
+        arrays.set(0, j, static_cast<float>(x));
+        arrays.set(1, j, static_cast<float>(-8.0 + 16.0 * unit(random)));
+    }
+}
+
+// Throughput of kernel_t on arrays small enough to stay in cache, then the largest error of its output against reference() in double
+// precision
+template <typename kernel_t, size_t array_size>
+void benchmark_tier(const char* function, const char* tier, weaved_array<float, 3, array_size>& arrays, double (*reference)(double, double), bool relative)
+{
+    call_SIMD_operation<3, array_size>(arrays, kernel_t());
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < TIER_TEST_ITERATIONS; i++) {
+        call_SIMD_operation<3, array_size>(arrays, kernel_t());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    double elements_per_second = static_cast<double>(array_size) * TIER_TEST_ITERATIONS / duration.count();
+
+    double worst = 0.0;
+    for (size_t j = 0; j < array_size; j++) {
+        double expected = reference(arrays.get(0, j), arrays.get(1, j));
+        double error = std::fabs(arrays.get(2, j) - expected);
+        worst = std::max(worst, relative ? error / std::fabs(expected) : error);
+    }
+
+    std::cout << "  " << std::left << std::setw(6) << function << std::setw(10) << tier << std::right
+        << std::fixed << std::setprecision(0) << std::setw(8) << elements_per_second / 1e6 << " M/s"
+        << std::scientific << std::setprecision(1) << std::setw(12) << worst << (relative ? " relative\n" : " absolute\n");
+}
+
+// Throughput and accuracy of exp, log, sin, pow and sqrt at each accuracy tier
+void benchmark_accuracy_tiers()
+{
+    weaved_array<float, 3, TIER_TEST_SIZE> arrays;
+    std::cout << "Accuracy tiers, " << TIER_TEST_SIZE << " elements on " << SIMD_backend_name(SIMD_backend_in_use()) << ":\n";
+
+    fill_tier_inputs(arrays, -80.0, 80.0, false);
+    benchmark_tier<exp_kernel<SIMD_fast_t>>("exp", "fast", arrays, reference_exp, true);
+    benchmark_tier<exp_kernel<SIMD_standard_t>>("exp", "standard", arrays, reference_exp, true);
+    benchmark_tier<exp_kernel<SIMD_precise_t>>("exp", "precise", arrays, reference_exp, true);
+
+    fill_tier_inputs(arrays, 1e-30, 1e30, true);
+    benchmark_tier<log_kernel<SIMD_fast_t>>("log", "fast", arrays, reference_log, true);
+    benchmark_tier<log_kernel<SIMD_standard_t>>("log", "standard", arrays, reference_log, true);
+    benchmark_tier<log_kernel<SIMD_precise_t>>("log", "precise", arrays, reference_log, true);
+
+    fill_tier_inputs(arrays, -100.0, 100.0, false);
+    benchmark_tier<sin_kernel<SIMD_fast_t>>("sin", "fast", arrays, reference_sin, false);
+    benchmark_tier<sin_kernel<SIMD_standard_t>>("sin", "standard", arrays, reference_sin, false);
+    benchmark_tier<sin_kernel<SIMD_precise_t>>("sin", "precise", arrays, reference_sin, false);
+
+    fill_tier_inputs(arrays, 0.01, 100.0, true);
+    benchmark_tier<pow_kernel<SIMD_fast_t>>("pow", "fast", arrays, reference_pow, true);
+    benchmark_tier<pow_kernel<SIMD_standard_t>>("pow", "standard", arrays, reference_pow, true);
+    benchmark_tier<pow_kernel<SIMD_precise_t>>("pow", "precise", arrays, reference_pow, true);
+
+    fill_tier_inputs(arrays, 1e-30, 1e30, true);
+    benchmark_tier<sqrt_kernel<SIMD_fast_t>>("sqrt", "fast", arrays, reference_sqrt, true);
+    benchmark_tier<sqrt_kernel<SIMD_standard_t>>("sqrt", "standard", arrays, reference_sqrt, true);
+    benchmark_tier<sqrt_kernel<SIMD_precise_t>>("sqrt", "precise", arrays, reference_sqrt, true);
+    std::cout << std::fixed << "\n";
+}
+
+// The engine's reductions against a plain loop over the same array
+void benchmark_reductions()
+{
+    auto inputs = gen_arrays<2, TEST_SIZE>();
+    const float* x = inputs.getArray(0);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    float scalar_sum = 0.0f;
+    for (size_t i = 0; i < TEST_SIZE; i++) {
+        scalar_sum += x[i];
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> scalar = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    float sum = reduce_sum(inputs, 0);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> reduced = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    float dot = reduce_dot(inputs, 0, 1);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> dotted = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    SIMD_arg_result largest = reduce_argmax(inputs, 0);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> searched = end - start;
+
+    std::cout << std::defaultfloat << std::setprecision(8) << "Reductions, " << TEST_SIZE << " elements (exact sum " << (TEST_SIZE - 1.0) * TEST_SIZE / 2 << "):\n";
+    std::cout << "  scalar loop sum: " << scalar.count() << " seconds, " << scalar_sum << "\n";
+    std::cout << "  reduce_sum: " << reduced.count() << " seconds, " << sum << "\n";
+    std::cout << "  reduce_dot: " << dotted.count() << " seconds, " << dot << "\n";
+    std::cout << "  reduce_argmax: " << searched.count() << " seconds, " << largest.value << " at " << largest.index << "\n\n";
+}
+
+// Running total of an array, serially and with the engine's two-pass scan
+void benchmark_scan()
+{
+    auto inputs = gen_arrays<2, TEST_SIZE>();
+    const float* x = inputs.getArray(0);
+    float* totals = inputs.getArray(1);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    float running = 0.0f;
+    for (size_t i = 0; i < TEST_SIZE; i++) {
+        running += x[i];
+        totals[i] = running;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> serial = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    call_SIMD_scan(inputs, 0, 1, SIMD_scans::sum());
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> scanned = end - start;
+
+    std::cout << std::defaultfloat << std::setprecision(8) << "Inclusive sum scan, " << TEST_SIZE << " elements:\n";
+    std::cout << "  serial loop: " << serial.count() << " seconds\n";
+    std::cout << "  call_SIMD_scan: " << scanned.count() << " seconds, last total " << inputs.get(1, TEST_SIZE - 1) << "\n";
+
+    // Max and min scans skip NaNs: every few elements is one, and the scan has to match a serial loop that never lets them in
+    const size_t checked = 100003;
+    weaved_array<float, 2, checked> samples;
+    for (size_t i = 0; i < checked; i++) {
+        samples.set(0, i, i % 5 == 0 ? NAN : static_cast<float>((i * 7919) % 1000));
+    }
+    auto mismatches = [&](bool largest) {
+        size_t wrong = 0;
+        float best = largest ? -INFINITY : INFINITY;
+        for (size_t i = 0; i < checked; i++) {
+            float value = samples.get(0, i);
+            best = largest ? (value > best ? value : best) : (value < best ? value : best);
+            wrong += samples.get(1, i) != best;
+        }
+        return wrong;
+    };
+    call_SIMD_scan(samples, 0, 1, SIMD_scans::max());
+    std::cout << "  max scan with NaNs, wrong outputs: " << mismatches(true) << "\n";
+    call_SIMD_scan(samples, 0, 1, SIMD_scans::min());
+    std::cout << "  min scan with NaNs, wrong outputs: " << mismatches(false) << "\n\n";
+}
+
+// 5-point moving average, serially and as a stencil
+void benchmark_stencil()
+{
+    auto inputs = gen_arrays<2, TEST_SIZE>();
+    const float* x = inputs.getArray(0);
+    float* averages = inputs.getArray(1);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 2; i < TEST_SIZE - 2; i++) {
+        averages[i] = (x[i - 2] + x[i - 1] + x[i] + x[i + 1] + x[i + 2]) * 0.2f;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> serial = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    call_SIMD_stencil<2>(inputs, 0, 1, moving_average_kernel());
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> stencil = end - start;
+
+    std::cout << std::defaultfloat << std::setprecision(8) << "5-point moving average, " << TEST_SIZE << " elements:\n";
+    std::cout << "  serial loop: " << serial.count() << " seconds\n";
+    std::cout << "  call_SIMD_stencil: " << stencil.count() << " seconds, average at 1000: " << inputs.get(1, 1000) << "\n\n";
+}
+
+// Seconds per launch of sum_arrays_kernel over num_arrays arrays of LAYOUT_TEST_ELEMENTS / num_arrays elements laid out by layout_t
+template <size_t num_arrays, typename layout_t>
+double time_layout()
+{
+    auto inputs = gen_arrays<num_arrays, LAYOUT_TEST_ELEMENTS / num_arrays, layout_t>();
+    call_SIMD_operation(inputs, sum_arrays_kernel<num_arrays>());
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < LAYOUT_TEST_ITERATIONS; i++) {
+        call_SIMD_operation(inputs, sum_arrays_kernel<num_arrays>());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = (end - start) / LAYOUT_TEST_ITERATIONS;
+    return duration.count();
+}
+
+// The same kernel over the same number of elements, split into more and more arrays. Planar arrays are read as one stream per array
+template <size_t num_arrays>
+void benchmark_layout()
+{
+    std::cout << "  " << num_arrays << " arrays: planar " << time_layout<num_arrays, planar_layout>()
+        << " s, tiled_layout<1> " << time_layout<num_arrays, tiled_layout<1>>()
+        << " s, tiled_layout<16> " << time_layout<num_arrays, tiled_layout<16>>() << " s\n";
+}
+
+void benchmark_layouts()
+{
+    std::cout << std::defaultfloat << std::setprecision(4) << "Sum of every array into arrays[0], " << LAYOUT_TEST_ELEMENTS << " elements in all:\n";
+    benchmark_layout<2>();
+    benchmark_layout<8>();
+    benchmark_layout<32>();
+    std::cout << "\n";
+}
+
+// First and second launch of a kernel writing two fresh arrays. The first launch also pays for every page fault unless allocator_t prefaulted
+template <typename allocator_t>
+void benchmark_allocator(const char* name)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    weaved_array<float, 2, TEST_SIZE, planar_layout, allocator_t> arrays;
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> allocation = end - start;
+
+    auto fill = [](auto** arrays, size_t index) {
+        typedef typename std::remove_pointer<typename std::remove_pointer<decltype(arrays)>::type>::type vec_t;
+        arrays[0][index] = vec_t(1.0f);
+        arrays[1][index] = vec_t(2.0f);
+    };
+
+    start = std::chrono::high_resolution_clock::now();
+    call_SIMD_operation(arrays, fill);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> first = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    call_SIMD_operation(arrays, fill);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> second = end - start;
+
+    std::cout << "  " << name << ": allocation " << allocation.count() << " s, first launch " << first.count() << " s, second launch " << second.count() << " s\n";
+}
+
+void benchmark_allocators()
+{
+    std::cout << std::defaultfloat << std::setprecision(4) << "Writing 2 fresh arrays of " << TEST_SIZE << " elements:\n";
+    benchmark_allocator<aligned_allocator<>>("aligned_allocator<>");
+    benchmark_allocator<aligned_allocator<true>>("aligned_allocator<true>");
+    benchmark_allocator<huge_page_allocator<false>>("huge_page_allocator<false>");
+    benchmark_allocator<huge_page_allocator<>>("huge_page_allocator<>");
+    std::cout << "\n";
+}
+
+// Seconds per call of launch, averaged over LAYOUT_TEST_ITERATIONS calls
+template <typename launch_t>
+double time_calls(const launch_t& launch)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < LAYOUT_TEST_ITERATIONS; i++) {
+        launch();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = (end - start) / LAYOUT_TEST_ITERATIONS;
+    return duration.count();
+}
+
+// Seconds per launch of pythagorean_kernel over arrays on engine, averaged over LAYOUT_TEST_ITERATIONS launches
+template <size_t num_arrays, size_t array_size>
+double time_launches(compute_engine& engine, const weaved_array<float, num_arrays, array_size>& arrays, SIMD_store_mode mode = SIMD_store_mode::cached)
+{
+    return time_calls([&] { engine.call_SIMD_operation(arrays, pythagorean_kernel(), mode); });
+}
+
+// Arrays filled from the main thread on a free-floating engine, against arrays first touched by the pinned workers of a numa engine.
+// Only differs on machines with more than one NUMA node
+void benchmark_numa()
+{
+    compute_engine floating;
+    auto filled = gen_arrays<2, TEST_SIZE>();
+
+    compute_engine pinned(compute_engine::default_thread_count(), worker_placement::numa);
+    weaved_array<float, 2, TEST_SIZE> touched;
+    pinned.first_touch(touched);
+
+    std::cout << std::defaultfloat << std::setprecision(4) << "pythagorean_kernel, " << TEST_SIZE << " elements, " << pinned.node_count() << " NUMA node(s):\n";
+    std::cout << "  filled by main thread: " << time_launches(floating, filled) << " s per launch\n";
+    std::cout << "  first touched per node: " << time_launches(pinned, touched) << " s per launch\n\n";
+}
+
+// The same launches over an array sized at compile time and one sized at run time, filled through the unchecked accessor
+void benchmark_dynamic_size()
+{
+    compute_engine engine;
+    auto fixed = gen_arrays<2, TEST_SIZE>();
+
+    size_t size = fixed.size();
+    weaved_array<float, 2, dynamic_array_size> dynamic(size);
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < size; j++) {
+            dynamic(i, j) = static_cast<float>(j);
+        }
+    }
+
+    std::cout << std::defaultfloat << std::setprecision(4) << "pythagorean_kernel, " << TEST_SIZE << " elements:\n";
+    std::cout << "  fixed size: " << time_launches(engine, fixed) << " s per launch\n";
+    std::cout << "  dynamic size: " << time_launches(engine, dynamic) << " s per launch\n\n";
+}
+
+// Filling one array element by element from the main thread, against the engine's fills with cached and streaming stores
+void benchmark_fill()
+{
+    compute_engine engine;
+    weaved_array<float, 2, TEST_SIZE> arrays;
+    engine.first_touch(arrays);
+
+    double gigabytes = TEST_SIZE * sizeof(float) / 1e9;
+    auto report = [&](const char* name, double seconds) {
+        std::cout << "  " << name << ": " << seconds << " s, " << gigabytes / seconds << " GB/s\n";
+    };
+
+    std::cout << std::defaultfloat << std::setprecision(4) << "Filling " << TEST_SIZE << " elements:\n";
+    report("set() loop", time_calls([&] {
+        for (size_t j = 0; j < TEST_SIZE; j++) {
+            arrays.set(0, j, static_cast<float>(j));
+        }
+    }));
+    report("fill_constant, cached", time_calls([&] { engine.fill_constant(arrays, 0, 1.0f, SIMD_store_mode::cached); }));
+    report("fill_constant, streaming", time_calls([&] { engine.fill_constant(arrays, 0, 1.0f, SIMD_store_mode::streaming); }));
+    report("fill_ramp, streaming", time_calls([&] { engine.fill_ramp(arrays, 0, 0.0f, 1.0f, SIMD_store_mode::streaming); }));
+    report("fill_copy, streaming", time_calls([&] { engine.fill_copy(arrays, 1, arrays.getArray(0), SIMD_store_mode::streaming); }));
+    report("fill_generate, streaming", time_calls([&] {
+        engine.fill_generate(arrays, 0, [](auto& value, size_t first) {
+            value = std::decay_t<decltype(value)>(static_cast<float>(first));
+        }, SIMD_store_mode::streaming);
+    }));
+    std::cout << "\n";
+}
+
+// Non-temporal stores on the pythagorean benchmark. In place, the kernel reads both arrays before writing them, so streaming saves
+// nothing and only changes how the writes reach memory. Written to a third array as an expression, streaming skips reading the
+// output into the cache first: 12 bytes of traffic per element instead of 16
+void benchmark_streaming()
+{
+    compute_engine engine;
+    auto arrays = gen_arrays<3, TEST_SIZE>();
+    auto hypotenuse = sqrt(arg<0>() * arg<0>() + arg<1>() * arg<1>());
+
+    auto time_expression = [&](SIMD_store_mode mode) {
+        return time_calls([&] { engine.call_SIMD_expression(arrays, 2, hypotenuse, mode); });
+    };
+
+    double elements = static_cast<double>(TEST_SIZE);
+    std::cout << std::defaultfloat << std::setprecision(4) << "pythagorean, " << TEST_SIZE << " elements, elements per second:\n";
+
+    auto in_place = gen_arrays<2, TEST_SIZE>();
+    std::cout << "  in place, cached stores: " << elements / time_launches(engine, in_place, SIMD_store_mode::cached) << "\n";
+    std::cout << "  in place, streaming stores: " << elements / time_launches(engine, in_place, SIMD_store_mode::streaming) << "\n";
+    std::cout << "  to a third array, cached stores: " << elements / time_expression(SIMD_store_mode::cached) << "\n";
+    std::cout << "  to a third array, streaming stores: " << elements / time_expression(SIMD_store_mode::streaming) << "\n\n";
+}
+
+// Keeping x and y while computing their hypotenuse. In place that means copying both first; a transform reads them and writes a
+// third array, whose old contents it never loads
+void benchmark_transform()
+{
+    compute_engine engine;
+    auto arrays = gen_arrays<4, TEST_SIZE>();
+
+    std::cout << std::defaultfloat << std::setprecision(4) << "hypotenuse of two arrays, " << TEST_SIZE << " elements, inputs kept:\n";
+    std::cout << "  copy, then in place: " << time_calls([&] {
+        engine.fill_copy(arrays, 2, arrays.getArray(0));
+        engine.fill_copy(arrays, 3, arrays.getArray(1));
+        engine.call_SIMD_operation(arrays, [](auto** simd_arrays, size_t index) { pythagorean_kernel()(simd_arrays + 2, index); });
+    }) << " s\n";
+    std::cout << "  transform, cached stores: " << time_calls([&] {
+        engine.call_SIMD_transform(arrays, SIMD_inputs<0, 1>(), SIMD_outputs<2>(), hypotenuse_kernel(), SIMD_store_mode::cached);
+    }) << " s\n";
+    std::cout << "  transform, streaming stores: " << time_calls([&] {
+        engine.call_SIMD_transform(arrays, SIMD_inputs<0, 1>(), SIMD_outputs<2>(), hypotenuse_kernel(), SIMD_store_mode::streaming);
+    }) << " s\n\n";
+}
+
+// Four cheap stages over two arrays of 128MB together, too big for any cache: four launches read and write both arrays from memory
+// four times, a pipeline once. The time per pass is the time per call, so the pipeline should come close to a single launch
+void benchmark_pipeline()
+{
+    compute_engine engine;
+    weaved_array<float, 2, dynamic_array_size> arrays(LAYOUT_TEST_ELEMENTS);
+    engine.fill_ramp(arrays, 0, 0.0f, 1.0f);
+    engine.fill_ramp(arrays, 1, 1.0f, 0.5f);
+
+    auto scale = [](auto** simd_arrays, size_t index) { simd_arrays[0][index] *= simd_arrays[1][index]; };
+    auto offset = [](auto** simd_arrays, size_t index) { simd_arrays[1][index] += simd_arrays[0][index]; };
+    auto pipeline = make_SIMD_pipeline(scale, offset, scale, offset);
+
+    std::cout << std::defaultfloat << std::setprecision(4) << "Four stages over two arrays, " << LAYOUT_TEST_ELEMENTS << " elements each, "
+        << SIMD_l2_cache_size() / 1024 << "KB of L2:\n";
+    std::cout << "  one launch: " << time_calls([&] {
+        engine.call_SIMD_operation(arrays, scale);
+    }) << " s\n";
+    std::cout << "  four launches: " << time_calls([&] {
+        engine.call_SIMD_operation(arrays, scale);
+        engine.call_SIMD_operation(arrays, offset);
+        engine.call_SIMD_operation(arrays, scale);
+        engine.call_SIMD_operation(arrays, offset);
+    }) << " s\n";
+    std::cout << "  pipeline: " << time_calls([&] {
+        engine.call_SIMD_pipeline(arrays, pipeline);
+    }) << " s\n\n";
+}
+
+// Fan out from arrays[0] to arrays[1] and arrays[2], then fan back in to arrays[3], over arrays too big for any cache. Launched one by
+// one every transform goes through memory; as a graph the three are fused into one blocked pass
+void benchmark_graph()
+{
+    compute_engine engine;
+    weaved_array<float, 4, dynamic_array_size> arrays(LAYOUT_TEST_ELEMENTS / 2);
+    engine.fill_ramp(arrays, 0, 0.0f, 1.0f);
+
+    auto twice = [](auto x) { return x + x; };
+    auto plus_one = [](auto x) { return x + decltype(x)(1.0f); };
+    auto product = [](auto x, auto y) { return x * y; };
+
+    auto graph = make_SIMD_graph(arrays);
+    graph.add_transform(SIMD_inputs<0>(), SIMD_outputs<1>(), twice);
+    graph.add_transform(SIMD_inputs<0>(), SIMD_outputs<2>(), plus_one);
+    graph.add_transform(SIMD_inputs<1, 2>(), SIMD_outputs<3>(), product);
+
+    std::cout << std::defaultfloat << std::setprecision(4) << "Fan out and in over four arrays, " << LAYOUT_TEST_ELEMENTS / 2 << " elements each:\n";
+    std::cout << "  three transforms: " << time_calls([&] {
+        engine.call_SIMD_transform(arrays, SIMD_inputs<0>(), SIMD_outputs<1>(), twice, SIMD_store_mode::cached);
+        engine.call_SIMD_transform(arrays, SIMD_inputs<0>(), SIMD_outputs<2>(), plus_one, SIMD_store_mode::cached);
+        engine.call_SIMD_transform(arrays, SIMD_inputs<1, 2>(), SIMD_outputs<3>(), product, SIMD_store_mode::cached);
+    }) << " s\n";
+    std::cout << "  graph: " << time_calls([&] {
+        engine.call_SIMD_graph(graph);
+    }) << " s\n\n";
+}
+
+// An ingest loop: every batch is prepared on the CPU (here, a scalar loop standing in for parsing), copied in and run through a kernel.
+// Blocking launches leave the caller idle while the kernel runs; with asynchronous ones it prepares the next batch into a second
+// buffer meanwhile. The gain depends on there being cores to spare, with none spare the two take about as long
+void benchmark_async()
+{
+    const size_t batches = 8;
+    const size_t batch_size = TEST_SIZE / 2;
+    compute_engine engine;
+    weaved_array<float, 2, dynamic_array_size> buffers[2] = { weaved_array<float, 2, dynamic_array_size>(batch_size), weaved_array<float, 2, dynamic_array_size>(batch_size) };
+    std::vector<float> staging(batch_size);
+
+    auto prepare = [&](size_t batch) {
+        for (size_t i = 0; i < batch_size; i++) {
+            staging[i] = std::sin(static_cast<float>(batch + i) * 0.001f);
+        }
+    };
+    auto copy_in = [&](weaved_array<float, 2, dynamic_array_size>& arrays) {
+        engine.fill_copy(arrays, 0, staging.data());
+        engine.fill_copy(arrays, 1, staging.data());
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t batch = 0; batch < batches; batch++) {
+        prepare(batch);
+        copy_in(buffers[0]);
+        engine.call_SIMD_operation(buffers[0], pythagorean_kernel());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> blocking = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    SIMD_future running[2];
+    for (size_t batch = 0; batch < batches; batch++) {
+        weaved_array<float, 2, dynamic_array_size>& arrays = buffers[batch % 2];
+        prepare(batch);
+        // The buffer is free again once the launch two batches back is done
+        if (running[batch % 2].valid()) {
+            running[batch % 2].wait();
+        }
+        copy_in(arrays);
+        running[batch % 2] = engine.call_SIMD_operation_async(arrays, pythagorean_kernel());
+    }
+    running[0].wait();
+    running[1].wait();
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> overlapped = end - start;
+
+    std::cout << std::defaultfloat << std::setprecision(4) << batches << " batches of " << batch_size << " elements, prepared and run through pythagorean_kernel, "
+        << engine.thread_count() << " threads:\n";
+    std::cout << "  blocking launches: " << blocking.count() << " s\n";
+    std::cout << "  asynchronous launches: " << overlapped.count() << " s\n\n";
+}
+
+// Unroll factors and prefetch distances over arrays sized for each level of the memory hierarchy: 16KB, 512KB and 16MB for both
+// arrays together, then well past the last level cache. Every cell runs the same number of elements, in billions per second
+void benchmark_launch_tuning()
+{
+    compute_engine engine;
+    const size_t sizes[] = { 2 * 1024, 64 * 1024, 2 * 1024 * 1024, 32 * 1024 * 1024 };
+    const char* levels[] = { "L1", "L2", "L3", "DRAM" };
+    const size_t unrolls[] = { 1, 2, 4, 8 };
+    const size_t distances[] = { 0, 64, 512, 4096 };
+    const size_t elements_per_cell = 256 * 1024 * 1024;
+
+    std::vector<weaved_array<float, 2, dynamic_array_size>> arrays;
+    for (size_t size : sizes) {
+        arrays.emplace_back(size);
+        engine.fill_ramp(arrays.back(), 0, 0.0f, 1.0f);
+        engine.fill_ramp(arrays.back(), 1, 0.0f, 1.0f);
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << "pythagorean_kernel, unroll x prefetch distance (elements):\n";
+    std::cout << "                   ";
+    for (const char* level : levels) {
+        std::cout << std::setw(8) << level;
+    }
+    std::cout << "\n";
+
+    for (size_t unroll : unrolls) {
+        for (size_t distance : distances) {
+            SIMD_launch_options options(SIMD_store_mode::cached, unroll, distance);
+            std::cout << "  unroll " << unroll << ", ahead " << std::setw(4) << distance;
+
+            for (size_t i = 0; i < arrays.size(); i++) {
+                size_t iterations = elements_per_cell / sizes[i];
+                auto start = std::chrono::high_resolution_clock::now();
+                for (size_t j = 0; j < iterations; j++) {
+                    engine.call_SIMD_operation(arrays[i], pythagorean_kernel(), options);
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                std::chrono::duration<double> duration = end - start;
+                std::cout << std::setw(8) << iterations * sizes[i] / duration.count() / 1e9;
+            }
+            std::cout << "\n";
+        }
+    }
+    std::cout << "\n";
+}
 
 int main() {
     std::cout << std::fixed << std::setprecision(2);
@@ -131,4 +809,22 @@ int main() {
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> duration = end - start;
     std::cout << std::setprecision(8) << "\nSIMD operation took " << duration.count() << " seconds.\n\n";
+
+    benchmark_launch_overhead();
+    benchmark_kernel_dispatch();
+    benchmark_accuracy_tiers();
+    benchmark_reductions();
+    benchmark_scan();
+    benchmark_stencil();
+    benchmark_layouts();
+    benchmark_allocators();
+    benchmark_numa();
+    benchmark_dynamic_size();
+    benchmark_fill();
+    benchmark_streaming();
+    benchmark_transform();
+    benchmark_launch_tuning();
+    benchmark_pipeline();
+    benchmark_graph();
+    benchmark_async();
 }